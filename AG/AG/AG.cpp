@@ -1,4 +1,5 @@
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <algorithm>
 #include <map>
@@ -7,6 +8,9 @@
 #include <random>
 #include <set>
 
+#include "../../Common/DistanceMatrix.h"
+#include "../../Common/MstTour.h"
+
 #define DEBUG false
 
 class Node;
@@ -110,6 +114,20 @@ public:
 	{
 	}
 
+	/**
+	 * \brief Konstruktor z macierzy odlegoci (np. wczytanej przez readDistanceMatrix)
+	 * \param nodes Wektor wzw
+	 * \param matrix Macierz n x n zapisana wierszami, INT_MAX oznacza brak krawdzi
+	 */
+	Graph(const vector<Node*>& nodes, const int* matrix)
+		: nodes_(nodes), directed(true)
+	{
+		forEachMatrixEdge(matrix, static_cast<int>(nodes.size()), [&](const int i, const int j, const int distance)
+		{
+			AddEdge(nodes[i], nodes[j], distance);
+		});
+	}
+
 	/**
 	 * \brief Destruktor
 	 */
@@ -158,6 +176,15 @@ public:
 		}
 	}
 
+	/**
+	 * \brief Trasa z minimalnego drzewa rozpinajcego (mstRoute z Common/MstTour.h)
+	 * \return Wektor wzw w kolejnoci odwiedzania
+	 */
+	[[nodiscard]] vector<Node*> MstRoute() const
+	{
+		return mstRoute(nodes_);
+	}
+
 	/**
 	 * \brief Wydobycie krawdzi z wektora wzw
 	 * \param nodes Wektor wzw
@@ -479,11 +506,15 @@ class Genetic
 
 	/**
 	 * \brief Tworzenie generacji pocztkowej
+	 * \param seed Trasa pocztkowa doczana do populacji (np. z Graph::MstRoute) lub pusty wektor;
+	 * trasa, ktra nie odwiedza kadego wza dokadnie raz albo przechodzi nieistniejc krawdzi, jest pomijana
 	 */
-	void Initialize()
+	void Initialize(const vector<Node*>& seed)
 	{
 		routes.reserve(pop_size);
-		for (int i = 0; i < pop_size; i++)
+		if (isValidRoute(graph->GetNodes(), seed))
+			routes.push_back(seed);
+		for (int i = routes.size(); i < pop_size; i++)
 		{
 			routes.push_back(GenerateRoute());
 		}
@@ -496,12 +527,14 @@ public:
 	 * \param no_gen Liczba generacji
 	 * \param elitism Procent elityzmu
 	 * \param mutation Procent mutacji
+	 * \param seed Trasa pocztkowa (np. z Graph::MstRoute) lub pusty wektor dla populacji w peni losowej
 	 */
-	explicit Genetic(Graph* graph, const int pop_size, const int no_gen, const int elitism, const int mutation)
+	explicit Genetic(Graph* graph, const int pop_size, const int no_gen, const int elitism, const int mutation,
+		const vector<Node*>& seed = {})
 		: graph(graph), pop_size(pop_size), rng(random_device()()), elitism(elitism),
 		mutation(mutation), no_gen(no_gen)
 	{
-		Initialize();
+		Initialize(seed);
 	}
 
 	/**
@@ -554,8 +587,36 @@ public:
 	}
 };
 
-int main()
+int main(int argc, char* argv[])
 {
+	// Graf peny z pliku macierzy odlegoci (np. zapisanej przez AStarHeap --apsp plik)
+	if (argc > 1)
+	{
+		int n = 0;
+		int* matrix = readDistanceMatrix(argv[1], &n);
+		if (matrix == nullptr || !isCompleteMatrix(matrix, n))
+		{
+			cout << "Niepoprawna macierz odleglosci: " << argv[1] << endl;
+			free(matrix);
+			return 1;
+		}
+
+		vector<Node*> nodes;
+		nodes.reserve(n);
+		for (int i = 0; i < n; ++i)
+		{
+			nodes.push_back(new Node);
+			nodes.back()->label = to_string(i);
+		}
+		Graph g(nodes, matrix);
+		free(matrix);
+
+		Genetic gen = Genetic(&g, 5000, 20, 10, 2, g.MstRoute());
+		gen.Optimize();
+		gen.PrintBestRoute();
+		return 0;
+	}
+
 	int N = 6;
 	vector<Node*> nodes;
 	nodes.reserve(N);
@@ -650,7 +711,7 @@ int main()
 	g.AddEdge(nodes[3], nodes[5], 5);
 	g.AddEdge(nodes[4], nodes[5], 16);
 
-	Genetic gen = Genetic(&g, 5000, 20, 10, 2);
+	Genetic gen = Genetic(&g, 5000, 20, 10, 2, g.MstRoute());
 	gen.Optimize();
 	gen.PrintBestRoute();
 }
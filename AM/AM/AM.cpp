@@ -1,5 +1,7 @@
 #include <iostream>
 #include <algorithm>
+#include <limits>
+#include <map>
 #include <numeric>
 #include <vector>
 #include <ranges>
@@ -7,6 +9,9 @@
 #include <random>
 #include <cfloat>
 
+#include "../../Common/DistanceMatrix.h"
+#include "../../Common/MstTour.h"
+
 class Node;
 using namespace std;
 
@@ -157,6 +162,20 @@ public:
 		return nodes_;
 	}
 
+	/**
+	 * \brief Konstruktor z macierzy odlegoci (np. wczytanej przez readDistanceMatrix)
+	 * \param nodes Wektor wzw
+	 * \param matrix Macierz n x n zapisana wierszami, INT_MAX oznacza brak krawdzi
+	 */
+	Graph(const vector<Node*>& nodes, const int* matrix)
+		: nodes_(nodes), directed(true)
+	{
+		forEachMatrixEdge(matrix, static_cast<int>(nodes.size()), [&](const int i, const int j, const int distance)
+		{
+			AddEdge(nodes[i], nodes[j], distance);
+		});
+	}
+
 	/**
 	 * \brief Pobranie iloci wzw
 	 * \return Ilo wzw
@@ -166,6 +185,15 @@ public:
 		return nodes_.size();
 	}
 
+	/**
+	 * \brief Trasa z minimalnego drzewa rozpinajcego (mstRoute z Common/MstTour.h)
+	 * \return Wektor wzw w kolejnoci odwiedzania
+	 */
+	[[nodiscard]] vector<Node*> MstRoute() const
+	{
+		return mstRoute(nodes_);
+	}
+
 	/**
 	 * \brief Dodanie krawdzi do grafu
 	 * \param source Wze rdowy
@@ -433,6 +461,33 @@ public:
 		routes[ant_k].push_back(start);
 	}
 
+	/**
+	 * \brief Zasilenie ladu feromonowego tras pocztkow (np. z Graph::MstRoute), ktra staje si te najlepsz znan tras
+	 * \param route Wektor wzw trasy (bez powtrzonego wza pocztkowego)
+	 * \return Fasz, jeli trasa nie odwiedza kadego wza dokadnie raz lub brakuje krawdzi midzy kolejnymi wzami;
+	 * lad pozostaje wtedy bez zmian
+	 */
+	bool Seed(const vector<Node*>& route)
+	{
+		if (!isValidRoute(graph.GetNodes(), route))
+			return false;
+
+		double length = 0;
+		for (size_t i = 0; i < route.size(); i++)
+			length += route[i]->GetEdge(route[(i + 1) % route.size()])->distance;
+
+		best_route = route;
+		best_route.push_back(route[0]);
+		best_length = length;
+		for (size_t i = 0; i < route.size(); i++)
+		{
+			best_route[i]->GetEdge(best_route[i + 1])->pheromone += Q / best_length;
+			if (Edge* re = best_route[i + 1]->GetEdge(best_route[i]))
+				re->pheromone += Q / best_length;
+		}
+		return true;
+	}
+
 	/**
 	 * \brief Optymalizacja trasy
 	 * \param iterations Ilo iteracji
@@ -489,8 +544,42 @@ public:
 	}
 };
 
-int main()
+int main(int argc, char* argv[])
 {
+	// Graf peny z pliku macierzy odlegoci (np. zapisanej przez AStarHeap --apsp plik)
+	if (argc > 1)
+	{
+		int n = 0;
+		int* matrix = readDistanceMatrix(argv[1], &n);
+		if (matrix == nullptr || !isCompleteMatrix(matrix, n))
+		{
+			cout << "Niepoprawna macierz odleglosci: " << argv[1] << endl;
+			free(matrix);
+			return 1;
+		}
+
+		vector<Node*> nodes;
+		nodes.reserve(n);
+		for (int i = 0; i < n; ++i)
+		{
+			nodes.push_back(new Node);
+			nodes.back()->label = to_string(i);
+		}
+		const Graph g(nodes, matrix);
+		free(matrix);
+
+		AntAlgorithm ant(g, 1, 1, 0.5, 5, 100);
+		ant.Seed(g.MstRoute());
+		ant.Optimize(10);
+		ant.PrintRoute();
+
+		for (const auto& node : nodes)
+		{
+			delete node;
+		}
+		return 0;
+	}
+
 	const int N = 6;
 	vector<Node*> nodes;
 	nodes.reserve(N);
@@ -571,6 +660,7 @@ int main()
 	g.AddEdge(nodes[4], nodes[5], 16, 1);
 
 	AntAlgorithm ant(g, 1, 1, 0.5, 5, 100);
+	ant.Seed(g.MstRoute());
 	ant.Optimize(10);
 	ant.PrintRoute();
 
@@ -1,9 +1,13 @@
 #define _USE_MATH_DEFINES
 #define MAX_IT 20000
 #include <iostream>
+#include <climits>
 #include <cmath>
 #include <random>
 
+#include "../../Common/DistanceMatrix.h"
+#include "../../Common/MstTour.h"
+
 using namespace std;
 
 using Function = double (*)(double);
@@ -247,6 +251,20 @@ void addEdge(Graph* g, int src, int dest, int weight) {
 	}
 }
 
+/// <summary>
+/// Tworzenie grafu skierowanego z macierzy odlegoci (np. wczytanej przez readDistanceMatrix)
+/// </summary>
+/// <param name="matrix">Macierz n x n zapisana wierszami, INT_MAX oznacza brak krawdzi</param>
+/// <param name="n">Ilo wierzchokw</param>
+/// <returns>Graf</returns>
+Graph* makeGraphFromMatrix(const int* matrix, int n) {
+	Graph* g = makeGraph(n, true);
+	forEachMatrixEdge(matrix, n, [g](int i, int j, int w) {
+		addEdge(g, i, j, w);
+	});
+	return g;
+}
+
 /// <summary>
 /// Tworzenie cieki z tablicy wierzchokw
 /// </summary>
@@ -332,6 +350,26 @@ void printHistory(vector<int*> history, int vertices)
 	}
 }
 
+/// <summary>
+/// Trasa pocztkowa z minimalnego drzewa rozpinajcego (mstOrder z Common/MstTour.h)
+/// </summary>
+/// <param name="g">Graf</param>
+/// <returns>Tablica wierzchokw trasy z powtrzonym wierzchokiem pocztkowym na kocu</returns>
+int* mstTour(Graph* g)
+{
+	vector<int> order = mstOrder(g->vertices, [g](int u, auto visit)
+	{
+		for (ListNode* el = g->array[u]; el; el = el->next)
+			visit(el->dest, el->weight);
+	});
+
+	int* path = new int[g->vertices + 1];
+	for (int i = 0; i < g->vertices; ++i)
+		path[i] = order[i];
+	path[g->vertices] = path[0];
+	return path;
+}
+
 /// <summary>
 /// Algorytm symulowanego wyarzania dla problemu komiwojaera
 /// </summary>
@@ -340,8 +378,9 @@ void printHistory(vector<int*> history, int vertices)
 /// <param name="alfa">Wspczynnik alfa</param>
 /// <param name="epoki">Liczba epok</param>
 /// <param name="proby">Liczba prb w epoce</param>
+/// <param name="initial">Trasa pocztkowa (np. z mstTour) lub nullptr dla trasy losowej</param>
 /// <returns>cieka</returns>
-Path TSP_ASW(Graph *g, double T, double alfa, int epoki, int proby)
+Path TSP_ASW(Graph *g, double T, double alfa, int epoki, int proby, const int* initial = nullptr)
 {
 	int* path = new int[g->vertices + 1];
 	int* pathCandidate = new int[g->vertices + 1];
@@ -355,6 +394,11 @@ Path TSP_ASW(Graph *g, double T, double alfa, int epoki, int proby)
 
 	for (int v = 0; v < g->vertices; ++v)
 	{
+		if (initial)
+		{
+			path[v] = initial[v];
+			continue;
+		}
 		int num = generateRandomInt(0, tmp.size() - 1);
 		path[v] = tmp.at(num);
 		tmp.erase(tmp.begin() + num);
@@ -427,8 +471,32 @@ Path TSP_ASW(Graph *g, double T, double alfa, int epoki, int proby)
 	return p;
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+	// Graf peny z pliku macierzy odlegoci (np. zapisanej przez AStarHeap --apsp plik)
+	if (argc > 1)
+	{
+		int n = 0;
+		int* matrix = readDistanceMatrix(argv[1], &n);
+		if (matrix == nullptr || !isCompleteMatrix(matrix, n))
+		{
+			cout << "Niepoprawna macierz odleglosci: " << argv[1] << endl;
+			free(matrix);
+			return 1;
+		}
+
+		Graph* graph = makeGraphFromMatrix(matrix, n);
+		free(matrix);
+		int* initial = mstTour(graph);
+		Path p = TSP_ASW(graph, 100, 0.5, 5, 3, initial);
+		delete[] initial;
+		cout << endl << "Wynik koncowy: " << endl;
+		printPath(graph, p);
+		delete graph;
+		delete[] p.path;
+		return 0;
+	}
+
 	//Value result = ASW(f, 0, 10, 1, 0.9, 100, 20);
 	//Value result = ASW(f, 0, 10, 1, 0.9, 5, 3);
 	//cout << endl << "Wynik koncowy: " << endl;
@@ -449,7 +517,9 @@ int main()
 	addEdge(graph, 2, 4, 165);
 	addEdge(graph, 3, 4, 302);
 
-	Path p = TSP_ASW(graph, 100, 0.5, 5, 3);
+	int* initial = mstTour(graph);
+	Path p = TSP_ASW(graph, 100, 0.5, 5, 3, initial);
+	delete[] initial;
 	cout << endl << "Wynik koncowy: " << endl;
 	printPath(graph, p);
 	delete graph;
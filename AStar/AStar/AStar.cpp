@@ -2,10 +2,32 @@
 
 #include <iostream>
 #include <algorithm>
-#include <map>
 #include <queue>
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <exception>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "StateSearch.h"
+#include "ConcurrentHashMap.h"
 
 using namespace std;
 
@@ -440,16 +462,219 @@ double haversine(const Coordinates &a, const Coordinates &b)
     return R * c;
 }
 
+#pragma region Komponenty
+
+/**
+ * \brief Indeks spjnych skadowych grafu
+ */
+struct ComponentIndex
+{
+	/**
+	 * \brief Numer sabo spjnej skadowej wierzchoka
+	 */
+	vector<int> weak;
+
+	/**
+	 * \brief Numer silnie spjnej skadowej wierzchoka (w odwrotnym porzdku topologicznym)
+	 */
+	vector<int> strong;
+
+	/**
+	 * \brief Liczba sabo spjnych skadowych
+	 */
+	int weakCount;
+
+	/**
+	 * \brief Liczba silnie spjnych skadowych
+	 */
+	int strongCount;
+};
+
+/**
+ * \brief Wyszukanie korzenia w strukturze zbiorw rozcznych (z kompresj cieki przez poowienie)
+ * \param parent Tablica rodzicw
+ * \param v Wierzchoek
+ * \return Korze zbioru
+ */
+int findRoot(vector<atomic<int>>& parent, int v)
+{
+    int p = parent[v].load(memory_order_relaxed);
+    while (p != v)
+    {
+        const int gp = parent[p].load(memory_order_relaxed);
+        if (gp != p)
+            parent[v].compare_exchange_weak(p, gp, memory_order_relaxed);
+        v = gp;
+        p = parent[v].load(memory_order_relaxed);
+    }
+    return v;
+}
+
+/**
+ * \brief Bezblokadowe poczenie zbiorw (korze o wikszym numerze podpinany pod mniejszy)
+ * \param parent Tablica rodzicw
+ * \param a Pierwszy wierzchoek
+ * \param b Drugi wierzchoek
+ */
+void unite(vector<atomic<int>>& parent, int a, int b)
+{
+    for (;;)
+    {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a == b)
+            return;
+        if (a < b)
+            swap(a, b);
+        int expected = a;
+        if (parent[a].compare_exchange_strong(expected, b, memory_order_relaxed))
+            return;
+    }
+}
+
+/**
+ * \brief Wyznaczanie silnie spjnych skadowych iteracyjnym algorytmem Tarjana
+ * \param g Graf
+ * \param strong Numery skadowych (wyjcie)
+ * \return Liczba skadowych
+ */
+int tarjanComponents(const Graph* g, vector<int>& strong)
+{
+    const int n = g->vertices;
+    vector<int> index(n, -1), low(n, 0), stack;
+    vector<bool> onStack(n, false);
+    vector<pair<int, ListNode*>> calls;
+    int counter = 0;
+    int components = 0;
+    strong.assign(n, -1);
+
+    for (int root = 0; root < n; ++root)
+    {
+        if (index[root] != -1)
+            continue;
+
+        calls.push_back({ root, g->array[root] });
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        onStack[root] = true;
+        while (!calls.empty())
+        {
+            auto& [v, it] = calls.back();
+            if (it)
+            {
+                const int w = it->dest;
+                it = it->next;
+                if (index[w] == -1)
+                {
+                    index[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    onStack[w] = true;
+                    calls.push_back({ w, g->array[w] });
+                }
+                else if (onStack[w])
+                    low[v] = min(low[v], index[w]);
+                continue;
+            }
+
+            const int done = v;
+            calls.pop_back();
+            if (!calls.empty())
+                low[calls.back().first] = min(low[calls.back().first], low[done]);
+            if (low[done] == index[done])
+            {
+                int w;
+                do
+                {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w] = false;
+                    strong[w] = components;
+                } while (w != done);
+                components++;
+            }
+        }
+    }
+    return components;
+}
+
+/**
+ * \brief Budowa indeksu skadowych: sabo spjne rwnolegle (zbiory rozczne), silnie spjne algorytmem Tarjana
+ * \param g Graf
+ * \param threads Liczba wtkw czcych zbiory
+ * \return Indeks skadowych
+ */
+ComponentIndex buildComponentIndex(const Graph* g, int threads = 1)
+{
+    const int n = g->vertices;
+    if (threads < 1)
+        threads = 1;
+
+    vector<atomic<int>> parent(n);
+    for (int v = 0; v < n; ++v)
+        parent[v].store(v, memory_order_relaxed);
+
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]()
+        {
+            for (int v = t; v < n; v += threads)
+                for (const ListNode* it = g->array[v]; it; it = it->next)
+                    unite(parent, v, it->dest);
+        });
+    for (auto& w : workers)
+        w.join();
+
+    ComponentIndex index;
+    index.weak.assign(n, -1);
+    index.weakCount = 0;
+    for (int v = 0; v < n; ++v)
+    {
+        const int root = findRoot(parent, v);
+        if (index.weak[root] == -1)
+            index.weak[root] = index.weakCount++;
+        index.weak[v] = index.weak[root];
+    }
+
+    if (g->directed)
+        index.strongCount = tarjanComponents(g, index.strong);
+    else
+    {
+        index.strong = index.weak;
+        index.strongCount = index.weakCount;
+    }
+    return index;
+}
+
+/**
+ * \brief Sprawdzenie w czasie staym, czy cel moe by osigalny ze startu.
+ * Wynik faszywy oznacza pewny brak cieki; prawdziwy w grafie skierowanym nie gwarantuje jej istnienia.
+ * \param index Indeks skadowych
+ * \param start Wze startowy
+ * \param goal Wze kocowy
+ * \return Fasz, jeli cieka na pewno nie istnieje
+ */
+bool mayReach(const ComponentIndex& index, const int start, const int goal)
+{
+    // Tarjan numeruje skadowe od uj, wic krawd moe prowadzi tylko do skadowej o nie wikszym numerze
+    return index.weak[start] == index.weak[goal] && index.strong[start] >= index.strong[goal];
+}
+
+#pragma endregion
+
 /**
  * \brief Algorytm A* dla grafu
  * \param g Graf
  * \param heuristic Tablica z heurystyk
  * \param start Wze startowy
  * \param goal Wze kocowy
+ * \param components Indeks skadowych do odrzucania nieosigalnych celw (opcjonalny)
  * \return Wyznaczona cieka
  */
-Path AStarF(const Graph* g, const int* heuristic, const int start, const int goal)
+Path AStarF(const Graph* g, const int* heuristic, const int start, const int goal, const ComponentIndex* components = nullptr)
 {
+    if (components && !mayReach(*components, start, goal))
+        return { vector<ListNode*>(), -1 };
+
     vector<int> path = vector<int>(g->vertices, -1);
     Queue* open = createQ(start, heuristic[start], 0);
     Queue* closed = nullptr;
@@ -533,10 +758,14 @@ Path AStarF(const Graph* g, const int* heuristic, const int start, const int goa
  * \param cords Tablica koordynatw
  * \param start Punkt startowy
  * \param goal Punkt kocowy
+ * \param components Indeks skadowych do odrzucania nieosigalnych celw (opcjonalny)
  * \return cieka wynikowa
  */
-Path AStarE(const Graph* g, double (*heuristic)(const Coordinates &, const Coordinates&), const Coordinates *cords, const int start, const int goal)
+Path AStarE(const Graph* g, double (*heuristic)(const Coordinates &, const Coordinates&), const Coordinates *cords, const int start, const int goal, const ComponentIndex* components = nullptr)
 {
+    if (components && !mayReach(*components, start, goal))
+        return { vector<ListNode*>(), -1 };
+
     vector<int> path = vector<int>(g->vertices, -1);
     Queue* open = createQ(start, heuristic(cords[start], cords[goal]) / 1000, 0);
     Queue* closed = nullptr;
@@ -680,12 +909,13 @@ int hamming(const vector<vector<int>> &current, const vector<vector<int>> &goal)
 int manhattan(const vector<vector<int>> &current, const vector<vector<int>> &goal)
 {
     int distance = 0;
-    const int size = current.size();
-    for (int i = 0; i < size; i++)
-        for (int j = 0; j < size; j++)
+    const int rows = current.size();
+    const int columns = current[0].size();
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < columns; j++)
             if (current[i][j] != 0)
-                for (int k = 0; k < size; k++)
-                    for (int l = 0; l < size; l++)
+                for (int k = 0; k < rows; k++)
+                    for (int l = 0; l < columns; l++)
                         if (current[i][j] == goal[k][l])
                             distance += abs(i - k) + abs(j - l);
     return distance;
@@ -718,152 +948,38 @@ bool isGoal(const vector<vector<int>>& current, const vector<vector<int>>& goal)
  */
 bool areEqual(const vector<vector<int>>& initial, const vector<vector<int>>& goal)
 {
-    bool equal = initial.size() == goal.size();
+    bool equal = initial.size() == goal.size() && !initial.empty();
     if (!equal) return false;
     for (int i = 0; i < initial.size(); ++i)
     {
-        if (initial[i].size() != goal[i].size() || initial[i].size() != initial.size())
+        if (initial[i].size() != goal[i].size() || initial[i].size() != initial[0].size())
             return false;
     }
     return true;
 }
 
-/**
- * \brief Sprawdzenie czy uoenie byo wczeniej utworzone
- * \param visited Mapa odwiedzonych uoe
- * \param current Aktualne uoenie
- * \return Informacja czy uoenie ju wystpio
- */
-bool isVisited(map<vector<vector<int>>, bool>& visited, const vector<vector<int>>& current)
-{
-    return visited[current];
-}
-
 /**
  * \brief Sprawdzenie czy ruch pustego klocka jest dozwolony
- * \param dim Wymiar ukadanki
+ * \param rows Liczba wierszy ukadanki
+ * \param columns Liczba kolumn ukadanki
  * \param x_pos Pozycja na osi x
  * \param y_pos Pozycja na osi y
  * \return Informacja czy ruch jest dozwolony
  */
-bool isInBounds(const int dim, int x_pos, const int y_pos)
-{
-    return x_pos >= 0 && x_pos < dim && y_pos >= 0 && y_pos < dim;
-}
-
-/**
- * \brief Pobranie wektora stanw ssiednich
- * \param current Stan aktualny
- * \param x_moveset Lista ruchw po osi x
- * \param y_moveset Lista ruchw po osi y
- * \return Wektor stanw ssiednich
- */
-vector<vector<vector<int>>> getNeighbors(vector<vector<int>> current, const vector<int> &x_moveset, const vector<int> &y_moveset)
+bool isInBounds(const int rows, const int columns, const int x_pos, const int y_pos)
 {
-    if (x_moveset.size() != y_moveset.size())
-        throw "Niezgodne wymiary ruchow";
-
-    Position n_pos{};
-    for (int i = 0; i < current.size(); i++)
-    {
-        for (int j = 0; j < current[0].size(); j++)
-        {
-            if (current[i][j] == 0)
-            {
-                n_pos.row = i;
-                n_pos.column = j;
-                break;
-            }
-        }
-    }
-
-    vector<vector<vector<int>>> neighbors;
-
-    for (int i = 0; i < x_moveset.size(); i++)
-    {
-	    const int x = n_pos.row;
-	    const int y = n_pos.column;
-        vector<vector<int>> vectors = current;
-        if (isInBounds(current.size(), x + x_moveset[i], y + y_moveset[i]))
-        {
-            swap(vectors[x + x_moveset[i]][y + y_moveset[i]], vectors[x][y]);
-            neighbors.push_back(vectors);
-        }
-    }
-
-    return neighbors;
+    return x_pos >= 0 && x_pos < rows && y_pos >= 0 && y_pos < columns;
 }
 
 /**
- * \brief Stan przechowujcy uoenie i liczb ruchw
- */
-struct State
-{
-	/**
-	 * \brief Aktualne pooenie klockw
-	 */
-	vector<vector<int>> position;
-
-	/**
-	 * \brief Numer zagbienia
-	 */
-	int step;
-};
-
-/**
- * \brief Komparator stanw ukadanki
- */
-struct cmp
-{
-	/**
-	 * \brief Rozwizanie
-	 */
-	vector<vector<int>> goal;
-
-	/**
-	 * \brief Funkcja heurystyczna
-	 */
-	int (*heuristicFunction)(const vector<vector<int>>&, const vector<vector<int>>&);
-
-	/**
-	 * \brief Porwnanie stanw
-	 * \param a Pierwszy stan
-	 * \param b Drugi stan
-	 * \return Informacja czy stan pierwszy stan ma wicej bdnych pozycji klockw ni stan drugi
-	 */
-	bool operator() (const State& a, const State &b) const
-    {
-	    const int a_estimation = heuristicFunction(a.position, goal) + a.step;
-	    const int b_estimation = heuristicFunction(b.position, goal) + b.step;
-        return a_estimation > b_estimation;
-    }
-
-	/**
-	 * \brief Konstruktor komparatora
-	 * \param goal Rozwizanie ukadanki
-	 */
-	cmp(const vector<vector<int>>& goal,
-		int(* heuristic_function)(const vector<vector<int>>&, const vector<vector<int>>&))
-		: goal(goal),
-		  heuristicFunction(heuristic_function)
-	{
-	}
-};
-
-
-/**
- * \brief Wywietlenie historii ukadanki
- * \param parent Mapa stanw poprzednich
- * \param s Stan kocowy
+ * \brief Wywietlenie uoenia ukadanki
+ * \param s Uoenie
  */
-void printHistory(map<vector<vector<int>>, vector<vector<int>>> &parent, const vector<vector<int>> &s)
+void printBoard(const vector<vector<int>> &s)
 {
-    if (parent.count(s))
-        printHistory(parent, parent[s]);
-
     for (int i = 0; i < s.size(); i++)
     {
-        for (int j = 0; j < s.size(); j++)
+        for (int j = 0; j < s[i].size(); j++)
         {
             if (s[i][j] != 0)
                 cout << s[i][j] << "\t";
@@ -883,7 +999,7 @@ void printSolution(const Solution &s)
 {
     for (int i = 0; i < s.placement.size(); i++)
     {
-        for (int j = 0; j < s.placement.size(); j++)
+        for (int j = 0; j < s.placement[i].size(); j++)
         {
             if (s.placement[i][j] != 0)
                 cout << s.placement[i][j] << "\t";
@@ -915,16 +1031,18 @@ int countInversions(const vector<int> &a)
 /**
  * \brief Sprawdzenie czy ukadanka ma rozwizanie
  * \param a Uoenie
+ * \param b Rozwizanie
  * \return Parzysto odwrce
  */
 bool parity(const vector<vector<int>>& a, const vector<vector<int>>& b)
 {
-    Position a0;
-    Position b0;
+    Position a0{};
+    Position b0{};
     vector<int> a_flatten;
     vector<int> b_flatten;
+    const int columns = a[0].size();
     for (int i = 0; i < a.size(); ++i)
-        for (int j = 0; j < a.size(); ++j)
+        for (int j = 0; j < columns; ++j)
         {
             if (a[i][j] == 0)
                 a0 = { i, j };
@@ -937,7 +1055,7 @@ bool parity(const vector<vector<int>>& a, const vector<vector<int>>& b)
     const int a_inversions = countInversions(a_flatten);
     const int b_inversions = countInversions(b_flatten);
 
-    if (a.size() % 2 == 0)
+    if (columns % 2 == 0)
     {
         if (a0.row % 2 == b0.row % 2)
             return a_inversions % 2 == b_inversions % 2;
@@ -946,68 +1064,1470 @@ bool parity(const vector<vector<int>>& a, const vector<vector<int>>& b)
     return a_inversions % 2 == b_inversions % 2;
 }
 
+#pragma region Tablica_odleglosci
+
 /**
- * \brief Algorytm A* dla ukadanek
- * \param initial Pozycja pocztkowa ukadanki
- * \param goal Pozycja kocowa ukadanki
- * \param heuristicFunction Funkcja heurystyczna
- * \return Rozwizanie
+ * \brief Maksymalna dugo rangowanej permutacji
+ */
+constexpr int RANK_MAX = 16;
+
+/**
+ * \brief Ranga permutacji metod MyrvoldRuskey w czasie liniowym
+ * \param perm Permutacja liczb 0..n-1
+ * \param n Dugo permutacji
+ * \return Ranga z przedziau [0, n!)
  */
-Solution AStar8(const vector<vector<int>>& initial, const vector<vector<int>>& goal, int (*heuristicFunction)(const vector<vector<int>>&, const vector<vector<int>>&))
+uint64_t rankPermutation(const int* perm, const int n)
 {
-    if (!areEqual(initial, goal))
-        throw "Zle wymiary poczatku i konca";
+    int p[RANK_MAX];
+    int inverse[RANK_MAX];
+    for (int i = 0; i < n; ++i)
+    {
+        p[i] = perm[i];
+        inverse[perm[i]] = i;
+    }
 
-    if (!parity(initial, goal))
-        throw "Przypadek bez rozwiazan";
+    uint64_t rank = 0;
+    uint64_t multiplier = 1;
+    for (int k = n; k > 1; --k)
+    {
+        const int s = p[k - 1];
+        swap(p[k - 1], p[inverse[k - 1]]);
+        swap(inverse[s], inverse[k - 1]);
+        rank += s * multiplier;
+        multiplier *= k;
+    }
+    return rank;
+}
+
+/**
+ * \brief Odtworzenie permutacji z rangi MyrvoldRuskey
+ * \param n Dugo permutacji
+ * \param rank Ranga
+ * \param perm Tablica na permutacj liczb 0..n-1
+ */
+void unrankPermutation(const int n, uint64_t rank, int* perm)
+{
+    for (int i = 0; i < n; ++i)
+        perm[i] = i;
+    for (int k = n; k > 0; --k)
+    {
+        swap(perm[k - 1], perm[rank % k]);
+        rank /= k;
+    }
+}
+
+/**
+ * \brief Parzysto permutacji na podstawie rozkadu na cykle
+ * \param perm Permutacja liczb 0..n-1
+ * \param n Dugo permutacji
+ * \return 0 dla permutacji parzystej, 1 dla nieparzystej
+ */
+int permutationParity(const int* perm, const int n)
+{
+    bool seen[RANK_MAX] = {};
+    int transpositions = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (seen[i])
+            continue;
+        int length = 0;
+        for (int j = i; !seen[j]; j = perm[j])
+        {
+            seen[j] = true;
+            length++;
+        }
+        transpositions += length - 1;
+    }
+    return transpositions % 2;
+}
+
+/**
+ * \brief Liczba pl ukadanki 3x3
+ */
+constexpr int TABLE_CELLS = 9;
+
+/**
+ * \brief Liczba permutacji klockw w jednej klasie parzystoci (8!/2)
+ */
+constexpr uint64_t TABLE_HALF = 20160;
+
+/**
+ * \brief Liczba wpisw tablicy odlegoci (9!/2)
+ */
+constexpr uint64_t TABLE_ENTRIES = TABLE_CELLS * TABLE_HALF;
+
+/**
+ * \brief Rozmiar nagwka pliku tablicy
+ */
+constexpr size_t TABLE_HEADER = 16;
+
+/**
+ * \brief Warto wpisu nieosigalnego (odlegoci zapisywane s modulo 15)
+ */
+constexpr uint8_t TABLE_UNKNOWN = 0xF;
+
+/**
+ * \brief Sprawdzenie czy uoenie 3x3 jest permutacj klockw 0..8
+ * \param cells Spaszczone uoenie
+ * \return Prawda, jeli kada warto 0..8 wystpuje dokadnie raz
+ */
+bool isValidBoard(const int* cells)
+{
+    bool seen[TABLE_CELLS] = {};
+    for (int i = 0; i < TABLE_CELLS; ++i)
+    {
+        if (cells[i] < 0 || cells[i] >= TABLE_CELLS || seen[cells[i]])
+            return false;
+        seen[cells[i]] = true;
+    }
+    return true;
+}
+
+/**
+ * \brief Indeks doskonaej funkcji skrtu dla ukadanki 3x3
+ * \param cells Spaszczone uoenie (poprawno sprawdza isValidBoard)
+ * \return Indeks z przedziau [0, 9!/2)
+ */
+uint64_t rankBoard(const int* cells)
+{
+    int tiles[TABLE_CELLS - 1];
+    int blank = 0;
+    for (int i = 0, t = 0; i < TABLE_CELLS; ++i)
+    {
+        if (cells[i] == 0)
+            blank = i;
+        else
+            tiles[t++] = cells[i] - 1;
+    }
+    // Ostatnia cyfra rangi wynika z parzystoci, a ta jest wsplna dla wszystkich stanw osigalnych
+    return blank * TABLE_HALF + rankPermutation(tiles, TABLE_CELLS - 1) % TABLE_HALF;
+}
+
+/**
+ * \brief Odtworzenie uoenia 3x3 z indeksu
+ * \param index Indeks
+ * \param parityClass Parzysto permutacji klockw
+ * \param cells Spaszczone uoenie
+ */
+void unrankBoard(const uint64_t index, const int parityClass, int* cells)
+{
+    const int blank = static_cast<int>(index / TABLE_HALF);
+    int tiles[TABLE_CELLS - 1];
+    unrankPermutation(TABLE_CELLS - 1, index % TABLE_HALF, tiles);
+    if (permutationParity(tiles, TABLE_CELLS - 1) != parityClass)
+        unrankPermutation(TABLE_CELLS - 1, index % TABLE_HALF + TABLE_HALF, tiles);
+    for (int i = 0, t = 0; i < TABLE_CELLS; ++i)
+        cells[i] = i == blank ? 0 : tiles[t++] + 1;
+}
 
+/**
+ * \brief Pobranie ssiadw uoenia 3x3
+ * \param cells Spaszczone uoenie
+ * \param out Tablica na indeksy ssiadw
+ * \return Liczba ssiadw
+ */
+int boardNeighbors(int* cells, uint64_t* out)
+{
     const vector<int> x = { 1,-1,0,0 };
     const vector<int> y = { 0,0,1,-1 };
+    const int blank = static_cast<int>(find(cells, cells + TABLE_CELLS, 0) - cells);
+    int count = 0;
+    for (int i = 0; i < x.size(); ++i)
+    {
+        const int row = blank / 3 + x[i];
+        const int column = blank % 3 + y[i];
+        if (!isInBounds(3, 3, row, column))
+            continue;
+        swap(cells[blank], cells[row * 3 + column]);
+        out[count++] = rankBoard(cells);
+        swap(cells[blank], cells[row * 3 + column]);
+    }
+    return count;
+}
+
+/**
+ * \brief Odczyt 4-bitowego wpisu tablicy
+ * \param data Dane tablicy
+ * \param index Indeks wpisu
+ * \return Odlego modulo 15 lub TABLE_UNKNOWN
+ */
+inline uint8_t getEntry(const uint8_t* data, const uint64_t index)
+{
+    return (data[index / 2] >> (index % 2 * 4)) & 0xF;
+}
 
-    map<vector<vector<int>>, bool> visited;
-    map<vector<vector<int>>, vector<vector<int>>> parent;
+/**
+ * \brief Atomowy zapis wpisu tablicy, o ile nie by jeszcze ustawiony
+ * \param data Dane tablicy
+ * \param index Indeks wpisu
+ * \param value Warto
+ * \return Prawda, jeli wpis zosta ustawiony przez to wywoanie
+ */
+bool trySetEntry(uint8_t* data, const uint64_t index, const uint8_t value)
+{
+    atomic_ref<uint8_t> byte(data[index / 2]);
+    const int shift = index % 2 * 4;
+    uint8_t expected = byte.load(memory_order_relaxed);
+    while (((expected >> shift) & 0xF) == TABLE_UNKNOWN)
+    {
+        const uint8_t desired = static_cast<uint8_t>((expected & ~(0xF << shift)) | (value << shift));
+        if (byte.compare_exchange_weak(expected, desired, memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
 
-    const cmp stateCompare(goal, heuristicFunction);
-    priority_queue<State, vector<State>, cmp> queue(stateCompare);
-    queue.push(State{ initial, 0 });
-    while (!queue.empty())
+/**
+ * \brief Budowa pliku z odlegociami wszystkich stanw 3x3 od rozwizania (rwnolegy BFS)
+ * \param goal Rozwizanie
+ * \param file cieka pliku
+ * \param threads Liczba wtkw
+ * \return Najwiksza odlego od rozwizania
+ */
+int buildDistanceTable(const vector<vector<int>>& goal, const string& file, int threads)
+{
+    if (goal.size() != 3 || goal[0].size() != 3)
+        throw "Tablica odleglosci wymaga ukladanki 3x3";
+    if (threads < 1)
+        threads = 1;
+
+    int target[TABLE_CELLS];
+    for (int i = 0; i < TABLE_CELLS; ++i)
+        target[i] = goal[i / 3][i % 3];
+    if (!isValidBoard(target))
+        throw "Niepoprawna wartosc klocka";
+    int goalTiles[TABLE_CELLS - 1];
+    for (int i = 0, t = 0; i < TABLE_CELLS; ++i)
+        if (target[i] != 0)
+            goalTiles[t++] = target[i] - 1;
+    const int parityClass = permutationParity(goalTiles, TABLE_CELLS - 1);
+
+    vector<uint8_t> data(TABLE_HEADER + (TABLE_ENTRIES + 1) / 2, 0xFF);
+    copy_n("P8DT", 4, data.begin());
+    copy_n(target, TABLE_CELLS, data.begin() + 4);
+    uint8_t* entries = data.data() + TABLE_HEADER;
+    trySetEntry(entries, rankBoard(target), 0);
+
+    int depth = 0;
+    atomic<uint64_t> added = 1;
+    while (added > 0)
     {
-        vector<vector<int>> cheapest = queue.top().position;
-        const int step = queue.top().step;
-        queue.pop();
-        visited[cheapest] = true;
-        if (cheapest == goal)
+        added = 0;
+        const uint8_t current = depth % 15;
+        const uint8_t next = (depth + 1) % 15;
+        const uint64_t slice = (TABLE_ENTRIES + threads - 1) / threads;
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t)
         {
-            printHistory(parent, cheapest);
-            return { cheapest, step };
-        }
-        vector<vector<vector<int>>> neighbors = getNeighbors(cheapest, x ,y);
-        vector<vector<vector<int>>>::iterator it;
-        for (it = neighbors.begin(); it != neighbors.end(); ++it)
-        {
-            vector<vector<int>> tmp = *it;
-            if (!isVisited(visited, tmp))
+            workers.emplace_back([&, t]
             {
-                parent.insert(pair<vector<vector<int>>, vector<vector<int>>>(tmp, cheapest));
-                queue.push(State{ tmp, step + 1 });
-            }
+                int cells[TABLE_CELLS];
+                uint64_t neighbors[4];
+                uint64_t local = 0;
+                const uint64_t end = min(TABLE_ENTRIES, (t + 1) * slice);
+                for (uint64_t i = t * slice; i < end; ++i)
+                {
+                    const uint8_t byte = atomic_ref<uint8_t>(entries[i / 2]).load(memory_order_relaxed);
+                    if (((byte >> (i % 2 * 4)) & 0xF) != current)
+                        continue;
+                    unrankBoard(i, parityClass, cells);
+                    const int count = boardNeighbors(cells, neighbors);
+                    for (int k = 0; k < count; ++k)
+                        if (trySetEntry(entries, neighbors[k], next))
+                            local++;
+                }
+                added += local;
+            });
         }
+        for (auto& w : workers)
+            w.join();
+        if (added > 0)
+            depth++;
     }
-    return { vector<vector<int>>(), -1 };
+
+    ofstream out(file, ios::binary | ios::trunc);
+    if (!out)
+        throw "Nie mozna zapisac pliku";
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<streamsize>(data.size()));
+    return depth;
 }
 
-int main()
+/**
+ * \brief Tablica odlegoci odwzorowana w pamici
+ */
+struct DistanceTable
 {
-	int V = 6;
-	bool directed = true;
-    const string labels[] = { "S", "A", "B", "C", "D", "G" };
-	Graph* g = makeGraph(V, directed, true, labels);
+	/**
+	 * \brief Rozwizanie, dla ktrego zbudowano tablic
+	 */
+	vector<vector<int>> goal;
 
-	addEdge(g, 0, 1, 1); // S -> A
-	addEdge(g, 0, 5, 10); // S -> G
-	addEdge(g, 1, 2, 2); // A -> B
-	addEdge(g, 1, 3, 1); // A -> C
-	addEdge(g, 2, 4, 5); // B -> D
+	/**
+	 * \brief Parzysto permutacji klockw rozwizania
+	 */
+	int parityClass;
+
+	/**
+	 * \brief Pocztek odwzorowanego pliku
+	 */
+	const uint8_t* view;
+
+	/**
+	 * \brief Rozmiar odwzorowanego pliku
+	 */
+	size_t size;
+
+#ifdef _WIN32
+	/**
+	 * \brief Uchwyt pliku
+	 */
+	HANDLE file;
+
+	/**
+	 * \brief Uchwyt odwzorowania
+	 */
+	HANDLE mapping;
+#else
+	/**
+	 * \brief Deskryptor pliku
+	 */
+	int fd;
+#endif
+};
+
+/**
+ * \brief Zamknicie tablicy odlegoci
+ * \param table Tablica odlegoci
+ */
+void closeDistanceTable(DistanceTable* table)
+{
+    if (!table)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(table->view);
+    CloseHandle(table->mapping);
+    CloseHandle(table->file);
+#else
+    munmap(const_cast<uint8_t*>(table->view), table->size);
+    close(table->fd);
+#endif
+    delete table;
+}
+
+/**
+ * \brief Otwarcie pliku tablicy odlegoci przez odwzorowanie w pamici
+ * \param file cieka pliku
+ * \return Tablica odlegoci lub pusty wskanik
+ */
+DistanceTable* openDistanceTable(const string& file)
+{
+    const size_t size = TABLE_HEADER + (TABLE_ENTRIES + 1) / 2;
+    DistanceTable* table = new DistanceTable();
+    table->size = size;
+#ifdef _WIN32
+    table->file = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (table->file == INVALID_HANDLE_VALUE)
+    {
+        delete table;
+        return nullptr;
+    }
+    table->mapping = CreateFileMappingA(table->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    table->view = table->mapping ? static_cast<const uint8_t*>(MapViewOfFile(table->mapping, FILE_MAP_READ, 0, 0, size)) : nullptr;
+    if (!table->view)
+    {
+        if (table->mapping)
+            CloseHandle(table->mapping);
+        CloseHandle(table->file);
+        delete table;
+        return nullptr;
+    }
+#else
+    table->fd = open(file.c_str(), O_RDONLY);
+    struct stat info {};
+    if (table->fd < 0 || fstat(table->fd, &info) != 0 || static_cast<size_t>(info.st_size) < size)
+    {
+        if (table->fd >= 0)
+            close(table->fd);
+        delete table;
+        return nullptr;
+    }
+    void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, table->fd, 0);
+    if (view == MAP_FAILED)
+    {
+        close(table->fd);
+        delete table;
+        return nullptr;
+    }
+    table->view = static_cast<const uint8_t*>(view);
+#endif
+    if (!equal(table->view, table->view + 4, "P8DT"))
+    {
+        closeDistanceTable(table);
+        return nullptr;
+    }
+    int target[TABLE_CELLS];
+    for (int i = 0; i < TABLE_CELLS; ++i)
+        target[i] = table->view[4 + i];
+    if (!isValidBoard(target))
+    {
+        closeDistanceTable(table);
+        return nullptr;
+    }
+    table->goal = vector<vector<int>>(3, vector<int>(3));
+    int goalTiles[TABLE_CELLS - 1];
+    for (int i = 0, t = 0; i < TABLE_CELLS; ++i)
+    {
+        table->goal[i / 3][i % 3] = table->view[4 + i];
+        if (table->view[4 + i] != 0)
+            goalTiles[t++] = table->view[4 + i] - 1;
+    }
+    table->parityClass = permutationParity(goalTiles, TABLE_CELLS - 1);
+    return table;
+}
+
+/**
+ * \brief Rozwizanie ukadanki 3x3 przez zachanne schodzenie po tablicy odlegoci
+ * \param initial Pozycja pocztkowa ukadanki
+ * \param table Tablica odlegoci
+ * \return Rozwizanie
+ */
+Solution tableSolve(const vector<vector<int>>& initial, const DistanceTable* table)
+{
+    const uint8_t* entries = table->view + TABLE_HEADER;
+    int cells[TABLE_CELLS];
+    for (int i = 0; i < TABLE_CELLS; ++i)
+        cells[i] = initial[i / 3][i % 3];
+    if (!isValidBoard(cells))
+        throw "Niepoprawna wartosc klocka";
+
+    const vector<int> x = { 1,-1,0,0 };
+    const vector<int> y = { 0,0,1,-1 };
+    uint8_t value = getEntry(entries, rankBoard(cells));
+    if (value == TABLE_UNKNOWN)
+        throw "Przypadek bez rozwiazan";
+
+    // Ssiednie stany rni si odlegoci o 1, wic wystarczy szuka wpisu o jeden mniejszego modulo 15
+    int moves = 0;
+    vector<vector<int>> board = initial;
+    while (board != table->goal)
+    {
+        const int blank = static_cast<int>(find(cells, cells + TABLE_CELLS, 0) - cells);
+        const uint8_t wanted = (value + 14) % 15;
+        bool found = false;
+        for (int i = 0; i < x.size() && !found; ++i)
+        {
+            const int row = blank / 3 + x[i];
+            const int column = blank % 3 + y[i];
+            if (!isInBounds(3, 3, row, column))
+                continue;
+            swap(cells[blank], cells[row * 3 + column]);
+            found = getEntry(entries, rankBoard(cells)) == wanted;
+            if (!found)
+                swap(cells[blank], cells[row * 3 + column]);
+        }
+        if (!found)
+            throw "Uszkodzona tablica odleglosci";
+        value = wanted;
+        moves++;
+        for (int i = 0; i < TABLE_CELLS; ++i)
+            board[i / 3][i % 3] = cells[i];
+    }
+    return { board, moves };
+}
+
+#pragma endregion
+
+#pragma region Stan_spakowany
+
+/**
+ * \brief Maksymalna liczba pl ukadanki zapisywanej w stanie spakowanym
+ */
+constexpr int PACKED_CELLS = 25;
+
+/**
+ * \brief Liczba bitw przypadajca na jedno pole ukadanki
+ */
+constexpr int PACKED_BITS = 5;
+
+/**
+ * \brief Maska pojedynczego pola ukadanki
+ */
+constexpr uint64_t PACKED_MASK = (1ull << PACKED_BITS) - 1;
+
+/**
+ * \brief Stan ukadanki spakowany w dwch sowach 64-bitowych (do 5x5 pl po 5 bitw)
+ */
+struct PackedState
+{
+	/**
+	 * \brief Modsze sowo
+	 */
+	uint64_t lo;
+
+	/**
+	 * \brief Starsze sowo
+	 */
+	uint64_t hi;
+
+	bool operator==(const PackedState& other) const
+	{
+		return lo == other.lo && hi == other.hi;
+	}
+
+	bool operator!=(const PackedState& other) const
+	{
+		return !(*this == other);
+	}
+
+	bool operator<(const PackedState& other) const
+	{
+		return hi < other.hi || (hi == other.hi && lo < other.lo);
+	}
+};
+
+/**
+ * \brief Przesunicie stanu w lewo
+ * \param s Stan
+ * \param n Liczba bitw
+ * \return Przesunity stan
+ */
+inline PackedState operator<<(const PackedState& s, const int n)
+{
+    if (n == 0)
+        return s;
+    if (n >= 64)
+        return { 0, s.lo << (n - 64) };
+    return { s.lo << n, (s.hi << n) | (s.lo >> (64 - n)) };
+}
+
+/**
+ * \brief Przesunicie stanu w prawo
+ * \param s Stan
+ * \param n Liczba bitw
+ * \return Przesunity stan
+ */
+inline PackedState operator>>(const PackedState& s, const int n)
+{
+    if (n == 0)
+        return s;
+    if (n >= 64)
+        return { s.hi >> (n - 64), 0 };
+    return { (s.lo >> n) | (s.hi << (64 - n)), s.hi >> n };
+}
+
+inline PackedState operator^(const PackedState& a, const PackedState& b)
+{
+    return { a.lo ^ b.lo, a.hi ^ b.hi };
+}
+
+inline PackedState operator&(const PackedState& a, const PackedState& b)
+{
+    return { a.lo & b.lo, a.hi & b.hi };
+}
+
+inline PackedState operator|(const PackedState& a, const PackedState& b)
+{
+    return { a.lo | b.lo, a.hi | b.hi };
+}
+
+inline PackedState operator~(const PackedState& s)
+{
+    return { ~s.lo, ~s.hi };
+}
+
+/**
+ * \brief Funkcja skrtu stanu spakowanego
+ */
+struct PackedStateHash
+{
+	size_t operator()(const PackedState& s) const
+	{
+		uint64_t h = s.lo ^ (s.hi * 0x9E3779B97F4A7C15ull);
+		h ^= h >> 31;
+		h *= 0xBF58476D1CE4E5B9ull;
+		h ^= h >> 29;
+		return static_cast<size_t>(h);
+	}
+};
+
+/**
+ * \brief Odczyt wartoci pola ze stanu spakowanego
+ * \param s Stan
+ * \param cell Indeks pola
+ * \return Warto klocka
+ */
+inline int getCell(const PackedState& s, const int cell)
+{
+    return static_cast<int>((s >> (cell * PACKED_BITS)).lo & PACKED_MASK);
+}
+
+/**
+ * \brief Zapis wartoci pola w stanie spakowanym
+ * \param s Stan
+ * \param cell Indeks pola
+ * \param value Warto klocka
+ */
+inline void setCell(PackedState& s, const int cell, const int value)
+{
+    const PackedState mask = PackedState{ PACKED_MASK, 0 } << (cell * PACKED_BITS);
+    s = (s & ~mask) | (PackedState{ static_cast<uint64_t>(value), 0 } << (cell * PACKED_BITS));
+}
+
+/**
+ * \brief Wze przeszukiwania dla stanw spakowanych
+ */
+struct PackedNode
+{
+	/**
+	 * \brief Stan ukadanki
+	 */
+	PackedState state;
+
+	/**
+	 * \brief Indeks pustego pola
+	 */
+	int blank;
+
+	/**
+	 * \brief Odlego Manhattan od rozwizania (aktualizowana przyrostowo przez PuzzleDomain)
+	 */
+	int distance = 0;
+
+	bool operator==(const PackedNode& other) const
+	{
+		return state == other.state;
+	}
+
+	bool operator<(const PackedNode& other) const
+	{
+		return state < other.state;
+	}
+};
+
+/**
+ * \brief Sprawdzenie czy uoenie mieci si w stanie spakowanym
+ * \param board Uoenie
+ * \return Prawda, jeli ukadanka ma najwyej PACKED_CELLS pl i klocki nie wiksze ni PACKED_MASK
+ */
+bool fitsPacked(const vector<vector<int>>& board)
+{
+    if (board.size() * board[0].size() > PACKED_CELLS)
+        return false;
+    for (const auto& row : board)
+        for (const int tile : row)
+            if (tile > static_cast<int>(PACKED_MASK))
+                return false;
+    return true;
+}
+
+/**
+ * \brief Pakowanie ukadanki do stanu 128-bitowego
+ * \param board Uoenie
+ * \return Wze ze stanem spakowanym
+ */
+PackedNode packBoard(const vector<vector<int>>& board)
+{
+    const int rows = board.size();
+    const int columns = board[0].size();
+    if (rows * columns > PACKED_CELLS)
+        throw "Zbyt duza ukladanka";
+
+    PackedNode node{ { 0, 0 }, -1 };
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < columns; ++j)
+        {
+            if (board[i][j] < 0 || board[i][j] > static_cast<int>(PACKED_MASK))
+                throw "Niepoprawna wartosc klocka";
+            if (board[i][j] == 0)
+                node.blank = i * columns + j;
+            setCell(node.state, i * columns + j, board[i][j]);
+        }
+    }
+    if (node.blank == -1)
+        throw "Brak pustego pola";
+    return node;
+}
+
+/**
+ * \brief Rozpakowanie stanu do postaci macierzy
+ * \param s Stan
+ * \param rows Liczba wierszy
+ * \param columns Liczba kolumn
+ * \return Uoenie
+ */
+vector<vector<int>> unpackBoard(const PackedState& s, const int rows, const int columns)
+{
+    vector<vector<int>> board(rows, vector<int>(columns));
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < columns; ++j)
+            board[i][j] = getCell(s, i * columns + j);
+    return board;
+}
+
+/**
+ * \brief Pobranie stanw ssiednich za pomoc przesuni bitowych
+ * \param current Stan aktualny
+ * \param rows Liczba wierszy
+ * \param columns Liczba kolumn
+ * \param x_moveset Lista ruchw po osi x
+ * \param y_moveset Lista ruchw po osi y
+ * \param out Tablica na stany ssiednie (co najmniej x_moveset.size() elementw)
+ * \return Liczba stanw ssiednich
+ */
+int getPackedNeighbors(const PackedNode& current, const int rows, const int columns, const vector<int>& x_moveset, const vector<int>& y_moveset, PackedNode* out)
+{
+    if (x_moveset.size() != y_moveset.size())
+        throw "Niezgodne wymiary ruchow";
+
+    const int x = current.blank / columns;
+    const int y = current.blank % columns;
+    int count = 0;
+    for (int i = 0; i < x_moveset.size(); i++)
+    {
+        if (!isInBounds(rows, columns, x + x_moveset[i], y + y_moveset[i]))
+            continue;
+        const int target = (x + x_moveset[i]) * columns + y + y_moveset[i];
+        const PackedState tile{ static_cast<uint64_t>(getCell(current.state, target)), 0 };
+        out[count++] = { current.state ^ (tile << (target * PACKED_BITS)) ^ (tile << (current.blank * PACKED_BITS)), target };
+    }
+    return count;
+}
+
+/**
+ * \brief Funkcja heurystyczna Manhattan dla stanu spakowanego
+ * \param s Stan
+ * \param cells Liczba pl
+ * \param columns Liczba kolumn
+ * \param goalCell Tablica pl docelowych dla kadego klocka
+ * \return Odlego od rozwizania
+ */
+int packedManhattan(const PackedState& s, const int cells, const int columns, const int* goalCell)
+{
+    int distance = 0;
+    PackedState it = s;
+    for (int i = 0; i < cells; ++i, it = it >> PACKED_BITS)
+    {
+        const int tile = static_cast<int>(it.lo & PACKED_MASK);
+        if (tile != 0)
+            distance += abs(i / columns - goalCell[tile] / columns) + abs(i % columns - goalCell[tile] % columns);
+    }
+    return distance;
+}
+
+#pragma endregion
+
+/**
+ * \brief Dziedzina ukadanki przesuwnej dla szablonu AStarSearch
+ */
+struct PuzzleDomain
+{
+	using State = vector<vector<int>>;
+	using Packed = PackedNode;
+
+	/**
+	 * \brief Liczba wierszy
+	 */
+	int rows;
+
+	/**
+	 * \brief Liczba kolumn
+	 */
+	int columns;
+
+	/**
+	 * \brief Rozwizanie
+	 */
+	PackedState goal;
+
+	/**
+	 * \brief Pole docelowe kadego klocka
+	 */
+	int goalCell[PACKED_MASK + 1];
+
+	/**
+	 * \brief Rozwizanie w postaci macierzy
+	 */
+	vector<vector<int>> goalBoard;
+
+	/**
+	 * \brief Funkcja heurystyczna na macierzach (pusty wskanik oznacza przyrostow odlego Manhattan na stanie spakowanym)
+	 */
+	int (*heuristicFunction)(const vector<vector<int>>&, const vector<vector<int>>&);
+
+	/**
+	 * \brief Uoenie robocze, do ktrego rozpakowywane s stany oceniane funkcj heurystyczn na macierzach
+	 */
+	mutable vector<vector<int>> scratch;
+
+	/**
+	 * \brief Lista ruchw po osi x
+	 */
+	vector<int> x = { 1,-1,0,0 };
+
+	/**
+	 * \brief Lista ruchw po osi y
+	 */
+	vector<int> y = { 0,0,1,-1 };
+
+	/**
+	 * \brief Konstruktor
+	 * \param goal Rozwizanie ukadanki
+	 * \param heuristicFunction Funkcja heurystyczna na macierzach lub pusty wskanik
+	 */
+	explicit PuzzleDomain(const vector<vector<int>>& goal,
+		int (*heuristicFunction)(const vector<vector<int>>&, const vector<vector<int>>&) = nullptr)
+		: rows(goal.size()), columns(goal[0].size()), goal(packBoard(goal).state), goalCell(), goalBoard(goal),
+		  heuristicFunction(heuristicFunction), scratch(goal)
+	{
+		for (int i = 0; i < rows * columns; ++i)
+			goalCell[getCell(this->goal, i)] = i;
+	}
+
+	/**
+	 * \brief Odlego pola od pola docelowego klocka
+	 * \param cell Indeks pola
+	 * \param tile Klocek
+	 * \return Odlego w metryce Manhattan
+	 */
+	[[nodiscard]] int TileDistance(const int cell, const int tile) const
+	{
+		return abs(cell / columns - goalCell[tile] / columns) + abs(cell % columns - goalCell[tile] % columns);
+	}
+
+	/**
+	 * \brief Pakowanie uoenia
+	 */
+	[[nodiscard]] Packed Pack(const State& s) const
+	{
+		Packed p = packBoard(s);
+		p.distance = packedManhattan(p.state, rows * columns, columns, goalCell);
+		return p;
+	}
+
+	/**
+	 * \brief Rozpakowanie uoenia
+	 */
+	[[nodiscard]] State Unpack(const Packed& p) const
+	{
+		return unpackBoard(p.state, rows, columns);
+	}
+
+	/**
+	 * \brief Skrt stanu
+	 */
+	[[nodiscard]] size_t Hash(const Packed& p) const
+	{
+		return PackedStateHash()(p.state);
+	}
+
+	/**
+	 * \brief Oszacowanie odlegoci od rozwizania
+	 */
+	[[nodiscard]] int Heuristic(const Packed& p) const
+	{
+		if (!heuristicFunction)
+			return p.distance;
+
+		for (int i = 0; i < rows; ++i)
+			for (int j = 0; j < columns; ++j)
+				scratch[i][j] = getCell(p.state, i * columns + j);
+		return heuristicFunction(scratch, goalBoard);
+	}
+
+	/**
+	 * \brief Sprawdzenie czy stan jest rozwizaniem
+	 */
+	[[nodiscard]] bool IsGoal(const Packed& p) const
+	{
+		return p.state == goal;
+	}
+
+	/**
+	 * \brief Przekazanie stanw ssiednich do funkcji odwiedzajcej
+	 * \param p Stan
+	 * \param visit Funkcja odwiedzajca (stan, koszt ruchu)
+	 */
+	template <typename F>
+	void Successors(const Packed& p, F&& visit) const
+	{
+		PackedNode neighbors[4];
+		const int count = getPackedNeighbors(p, rows, columns, x, y, neighbors);
+		for (int i = 0; i < count; ++i)
+		{
+			// Klocek przesunity z nowego pustego pola na dawne puste pole zmienia tylko swj skadnik odlegoci
+			const int tile = getCell(neighbors[i].state, p.blank);
+			neighbors[i].distance = p.distance - TileDistance(neighbors[i].blank, tile) + TileDistance(p.blank, tile);
+			visit(neighbors[i], 1);
+		}
+	}
+};
+
+/**
+ * \brief Dziedzina ukadanki na macierzach, dla uoe nie mieszczcych si w stanie spakowanym
+ */
+struct BoardDomain
+{
+	using State = vector<vector<int>>;
+	using Packed = vector<vector<int>>;
+
+	/**
+	 * \brief Rozwizanie
+	 */
+	vector<vector<int>> goal;
+
+	/**
+	 * \brief Funkcja heurystyczna
+	 */
+	int (*heuristicFunction)(const vector<vector<int>>&, const vector<vector<int>>&);
+
+	/**
+	 * \brief Lista ruchw po osi x
+	 */
+	vector<int> x = { 1,-1,0,0 };
+
+	/**
+	 * \brief Lista ruchw po osi y
+	 */
+	vector<int> y = { 0,0,1,-1 };
+
+	/**
+	 * \brief Konstruktor
+	 * \param goal Rozwizanie ukadanki
+	 * \param heuristicFunction Funkcja heurystyczna lub pusty wskanik (odlego Manhattan)
+	 */
+	explicit BoardDomain(const vector<vector<int>>& goal,
+		int (*heuristicFunction)(const vector<vector<int>>&, const vector<vector<int>>&) = nullptr)
+		: goal(goal), heuristicFunction(heuristicFunction ? heuristicFunction : manhattan)
+	{
+	}
+
+	/**
+	 * \brief Pakowanie uoenia (stan pozostaje macierz)
+	 */
+	[[nodiscard]] Packed Pack(const State& s) const
+	{
+		return s;
+	}
+
+	/**
+	 * \brief Rozpakowanie uoenia
+	 */
+	[[nodiscard]] State Unpack(const Packed& p) const
+	{
+		return p;
+	}
+
+	/**
+	 * \brief Skrt stanu (FNV-1a po kolejnych klockach)
+	 */
+	[[nodiscard]] size_t Hash(const Packed& p) const
+	{
+		uint64_t h = 0xCBF29CE484222325ull;
+		for (const auto& row : p)
+			for (const int tile : row)
+				h = (h ^ static_cast<uint64_t>(tile)) * 0x100000001B3ull;
+		return static_cast<size_t>(h);
+	}
+
+	/**
+	 * \brief Oszacowanie odlegoci od rozwizania
+	 */
+	[[nodiscard]] int Heuristic(const Packed& p) const
+	{
+		return heuristicFunction(p, goal);
+	}
+
+	/**
+	 * \brief Sprawdzenie czy stan jest rozwizaniem
+	 */
+	[[nodiscard]] bool IsGoal(const Packed& p) const
+	{
+		return p == goal;
+	}
+
+	/**
+	 * \brief Przekazanie stanw ssiednich do funkcji odwiedzajcej
+	 * \param p Stan
+	 * \param visit Funkcja odwiedzajca (stan, koszt ruchu)
+	 */
+	template <typename F>
+	void Successors(const Packed& p, F&& visit) const
+	{
+		const int rows = p.size();
+		const int columns = p[0].size();
+		int blank = 0;
+		while (p[blank / columns][blank % columns] != 0)
+			blank++;
+
+		for (int i = 0; i < static_cast<int>(x.size()); ++i)
+		{
+			const int row = blank / columns + x[i];
+			const int column = blank % columns + y[i];
+			if (!isInBounds(rows, columns, row, column))
+				continue;
+			Packed next = p;
+			swap(next[blank / columns][blank % columns], next[row][column]);
+			visit(next, 1);
+		}
+	}
+};
+
+/**
+ * \brief Przeszukanie dziedziny ukadanki i wypisanie uoe na ciece
+ * \param domain Dziedzina
+ * \param initial Pozycja pocztkowa ukadanki
+ * \return Rozwizanie
+ */
+template <SearchDomain D>
+Solution solvePuzzle(const D& domain, const vector<vector<int>>& initial)
+{
+    const SearchResult<vector<vector<int>>> result = AStarSearch(domain, initial);
+    if (result.cost < 0)
+        return { vector<vector<int>>(), -1 };
+
+    for (const auto& board : result.path)
+        printBoard(board);
+    return { result.path.back(), result.cost };
+}
+
+/**
+ * \brief Algorytm A* dla ukadanek jako instancja szablonu AStarSearch
+ * \param initial Pozycja pocztkowa ukadanki
+ * \param goal Pozycja kocowa ukadanki
+ * \param heuristicFunction Funkcja heurystyczna (pusty wskanik oznacza odlego Manhattan)
+ * \param table Tablica odlegoci dla ukadanek 3x3 (opcjonalna)
+ * \return Rozwizanie
+ */
+Solution AStar8(const vector<vector<int>>& initial, const vector<vector<int>>& goal, int (*heuristicFunction)(const vector<vector<int>>&, const vector<vector<int>>&) = nullptr, const DistanceTable* table = nullptr)
+{
+    if (!areEqual(initial, goal))
+        throw "Zle wymiary poczatku i konca";
+
+    if (!parity(initial, goal))
+        throw "Przypadek bez rozwiazan";
+
+    if (table && table->goal == goal)
+        return tableSolve(initial, table);
+
+    // Ukadanki o wicej ni PACKED_CELLS polach lub z klockami powyej PACKED_MASK s przeszukiwane na macierzach
+    if (fitsPacked(initial) && fitsPacked(goal))
+        return solvePuzzle(PuzzleDomain(goal, heuristicFunction), initial);
+    return solvePuzzle(BoardDomain(goal, heuristicFunction), initial);
+}
+
+#pragma region BFS_zewnetrzny
+
+/**
+ * \brief Liczba stanw odczytywanych z pliku za jednym razem
+ */
+constexpr size_t EXTERNAL_CHUNK = 1 << 16;
+
+/**
+ * \brief Najwiksza liczba plikw przebiegw scalanych w jednym przejciu
+ */
+constexpr size_t EXTERNAL_FANIN = 64;
+
+/**
+ * \brief Sortowanie, usuwanie duplikatw i zapis bloku stanw do pliku
+ * \param buffer Blok stanw
+ * \param file cieka pliku
+ */
+void writeRun(vector<PackedState>& buffer, const string& file)
+{
+    sort(buffer.begin(), buffer.end());
+    buffer.erase(unique(buffer.begin(), buffer.end()), buffer.end());
+    ofstream out(file, ios::binary | ios::trunc);
+    if (!out)
+        throw "Nie mozna zapisac pliku";
+    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<streamsize>(buffer.size() * sizeof(PackedState)));
+    buffer.clear();
+}
+
+/**
+ * \brief Strumieniowy odczyt posortowanego pliku stanw
+ */
+class RunReader
+{
+	/**
+	 * \brief Strumie pliku
+	 */
+	ifstream in;
+
+	/**
+	 * \brief Bufor odczytu
+	 */
+	vector<PackedState> buffer;
+
+	/**
+	 * \brief Pozycja w buforze
+	 */
+	size_t position = 0;
+
+	/**
+	 * \brief Doczytanie kolejnego fragmentu pliku
+	 */
+	void Fill()
+	{
+		buffer.resize(EXTERNAL_CHUNK);
+		in.read(reinterpret_cast<char*>(buffer.data()), static_cast<streamsize>(EXTERNAL_CHUNK * sizeof(PackedState)));
+		buffer.resize(static_cast<size_t>(in.gcount()) / sizeof(PackedState));
+		position = 0;
+	}
+
+public:
+	/**
+	 * \brief Konstruktor
+	 * \param file cieka pliku (brak pliku oznacza pusty strumie)
+	 */
+	explicit RunReader(const string& file)
+		: in(file, ios::binary)
+	{
+		if (in)
+			Fill();
+	}
+
+	/**
+	 * \brief Sprawdzenie czy pozostay stany do odczytu
+	 * \return Prawda, jeli strumie nie jest wyczerpany
+	 */
+	[[nodiscard]] bool HasNext() const
+	{
+		return position < buffer.size();
+	}
+
+	/**
+	 * \brief Podejrzenie biecego stanu
+	 * \return Biecy stan
+	 */
+	[[nodiscard]] const PackedState& Peek() const
+	{
+		return buffer[position];
+	}
+
+	/**
+	 * \brief Przejcie do nastpnego stanu
+	 */
+	void Next()
+	{
+		if (++position == buffer.size() && in)
+			Fill();
+	}
+
+	/**
+	 * \brief Przewinicie strumienia do pierwszego stanu nie mniejszego ni zadany
+	 * \param s Stan
+	 * \return Prawda, jeli stan wystpuje w strumieniu
+	 */
+	bool Contains(const PackedState& s)
+	{
+		while (HasNext() && Peek() < s)
+			Next();
+		return HasNext() && Peek() == s;
+	}
+};
+
+/**
+ * \brief cieka pliku warstwy BFS
+ * \param dir Katalog roboczy
+ * \param depth Gboko warstwy
+ * \return cieka pliku
+ */
+string layerFile(const string& dir, const int depth)
+{
+    return dir + "/layer_" + to_string(depth) + ".bin";
+}
+
+/**
+ * \brief Scalenie posortowanych plikw przebiegw w jeden plik bez duplikatw
+ * \param inputs Pliki przebiegw (najwyej EXTERNAL_FANIN)
+ * \param file Plik wynikowy
+ * \param current Warstwa d, ktrej stany s pomijane (lub nullptr)
+ * \param previous Warstwa d-1, ktrej stany s pomijane (lub nullptr)
+ * \return Liczba zapisanych stanw
+ */
+uint64_t mergeRuns(const vector<string>& inputs, const string& file, RunReader* current = nullptr, RunReader* previous = nullptr)
+{
+    vector<RunReader> readers;
+    readers.reserve(inputs.size());
+    for (const auto& f : inputs)
+        readers.emplace_back(f);
+
+    using HeapItem = pair<PackedState, int>;
+    auto greaterItem = [](const HeapItem& a, const HeapItem& b) { return b.first < a.first; };
+    priority_queue<HeapItem, vector<HeapItem>, decltype(greaterItem)> heap(greaterItem);
+    for (int r = 0; r < static_cast<int>(readers.size()); ++r)
+        if (readers[r].HasNext())
+            heap.push({ readers[r].Peek(), r });
+
+    ofstream out(file, ios::binary | ios::trunc);
+    if (!out)
+        throw "Nie mozna zapisac pliku";
+    vector<PackedState> output;
+    output.reserve(EXTERNAL_CHUNK);
+    uint64_t size = 0;
+    bool hasLast = false;
+    PackedState last{};
+    while (!heap.empty())
+    {
+        auto [s, r] = heap.top();
+        heap.pop();
+        readers[r].Next();
+        if (readers[r].HasNext())
+            heap.push({ readers[r].Peek(), r });
+
+        if (hasLast && s == last)
+            continue;
+        hasLast = true;
+        last = s;
+        if ((current && current->Contains(s)) || (previous && previous->Contains(s)))
+            continue;
+
+        output.push_back(s);
+        size++;
+        if (output.size() == EXTERNAL_CHUNK)
+        {
+            out.write(reinterpret_cast<const char*>(output.data()), static_cast<streamsize>(output.size() * sizeof(PackedState)));
+            output.clear();
+        }
+    }
+    out.write(reinterpret_cast<const char*>(output.data()), static_cast<streamsize>(output.size() * sizeof(PackedState)));
+    out.close();
+    if (!out)
+        throw "Nie mozna zapisac pliku";
+    return size;
+}
+
+/**
+ * \brief Rozwinicie fragmentu warstwy do plikw przebiegw
+ * \param states Stany warstwy
+ * \param begin Pierwszy rozwijany indeks
+ * \param end Indeks za ostatnim rozwijanym stanem
+ * \param rows Liczba wierszy
+ * \param columns Liczba kolumn
+ * \param local Bufor wtku
+ * \param capacity Pojemno bufora wtku
+ * \param runs Licznik plikw przebiegw
+ * \param dir Katalog roboczy
+ * \param files Lista plikw przebiegw wtku
+ */
+void expandSlice(const vector<PackedState>& states, const size_t begin, const size_t end, const int rows, const int columns,
+    vector<PackedState>& local, const size_t capacity, atomic<int>& runs, const string& dir, vector<string>& files)
+{
+    const vector<int> x = { 1,-1,0,0 };
+    const vector<int> y = { 0,0,1,-1 };
+    PackedNode neighbors[4];
+    for (size_t i = begin; i < end; ++i)
+    {
+        PackedNode node{ states[i], 0 };
+        while (getCell(node.state, node.blank) != 0)
+            node.blank++;
+        const int count = getPackedNeighbors(node, rows, columns, x, y, neighbors);
+        for (int k = 0; k < count; ++k)
+            local.push_back(neighbors[k].state);
+        if (local.size() >= capacity)
+        {
+            files.push_back(dir + "/run_" + to_string(runs++) + ".bin");
+            writeRun(local, files.back());
+        }
+    }
+}
+
+/**
+ * \brief Przeszukiwanie wszerz w pamici zewntrznej z detekcj duplikatw przez scalanie
+ * \param initial Uoenie pocztkowe
+ * \param dir Katalog roboczy na pliki warstw i przebiegw
+ * \param memoryBudget Limit pamici na bufory stanw w bajtach
+ * \param threads Liczba wtkw rozwijajcych warstw
+ * \param maxDepth Maksymalna gboko (-1 oznacza brak limitu)
+ * \return Liczba stanw w kolejnych warstwach
+ */
+vector<uint64_t> externalBFS(const vector<vector<int>>& initial, const string& dir, const size_t memoryBudget, int threads, const int maxDepth = -1)
+{
+    const int rows = initial.size();
+    const int columns = initial[0].size();
+    if (threads < 1)
+        threads = 1;
+
+    const size_t capacity = max<size_t>(EXTERNAL_CHUNK, memoryBudget / sizeof(PackedState) / (2 * threads));
+    vector<PackedState> first = { packBoard(initial).state };
+    writeRun(first, layerFile(dir, 0));
+
+    vector<uint64_t> layers = { 1 };
+    atomic<int> runs = 0;
+    for (int depth = 0; maxDepth < 0 || depth < maxDepth; ++depth)
+    {
+        vector<vector<PackedState>> local(threads);
+        vector<vector<string>> files(threads);
+        for (auto& l : local)
+            l.reserve(capacity + 4);
+
+        ifstream in(layerFile(dir, depth), ios::binary);
+        vector<PackedState> states(EXTERNAL_CHUNK * threads);
+        while (in)
+        {
+            in.read(reinterpret_cast<char*>(states.data()), static_cast<streamsize>(states.size() * sizeof(PackedState)));
+            const size_t count = static_cast<size_t>(in.gcount()) / sizeof(PackedState);
+            if (count == 0)
+                break;
+            const size_t slice = (count + threads - 1) / threads;
+            vector<thread> workers;
+            vector<exception_ptr> errors(threads);
+            for (int t = 0; t < threads; ++t)
+            {
+                const size_t begin = min(count, t * slice);
+                const size_t end = min(count, begin + slice);
+                workers.emplace_back([&, t, begin, end]()
+                {
+                    try
+                    {
+                        expandSlice(states, begin, end, rows, columns, local[t], capacity, runs, dir, files[t]);
+                    }
+                    catch (...)
+                    {
+                        errors[t] = current_exception();
+                    }
+                });
+            }
+            for (auto& w : workers)
+                w.join();
+            for (const auto& e : errors)
+                if (e)
+                    rethrow_exception(e);
+        }
+        in.close();
+
+        vector<string> all;
+        for (int t = 0; t < threads; ++t)
+        {
+            if (!local[t].empty())
+            {
+                files[t].push_back(dir + "/run_" + to_string(runs++) + ".bin");
+                writeRun(local[t], files[t].back());
+            }
+            all.insert(all.end(), files[t].begin(), files[t].end());
+        }
+
+        // Scalanie w przejciach po najwyej EXTERNAL_FANIN plikw, aby ograniczy liczb otwartych plikw
+        while (all.size() > EXTERNAL_FANIN)
+        {
+            vector<string> merged;
+            for (size_t i = 0; i < all.size(); i += EXTERNAL_FANIN)
+            {
+                const vector<string> group(all.begin() + i, all.begin() + min(all.size(), i + EXTERNAL_FANIN));
+                merged.push_back(dir + "/run_" + to_string(runs++) + ".bin");
+                mergeRuns(group, merged.back());
+                for (const auto& f : group)
+                    remove(f.c_str());
+            }
+            all.swap(merged);
+        }
+
+        // Ostatnie scalanie odrzuca stany z warstw d oraz d-1 (graf jest nieskierowany)
+        RunReader current(layerFile(dir, depth));
+        RunReader previous(depth > 0 ? layerFile(dir, depth - 1) : string());
+        const uint64_t size = mergeRuns(all, layerFile(dir, depth + 1), &current, &previous);
+        for (const auto& f : all)
+            remove(f.c_str());
+
+        if (size == 0)
+        {
+            remove(layerFile(dir, depth + 1).c_str());
+            break;
+        }
+        layers.push_back(size);
+    }
+    return layers;
+}
+
+#pragma endregion
+
+#pragma region Wspolbiezna_lista_zamknieta
+
+/**
+ * \brief Zapis stanu ukadanki do 4x4 w jednym sowie 64-bitowym (4 bity na pole)
+ * \param s Stan spakowany
+ * \param cells Liczba pl (najwyej 16)
+ * \return Stan w 64 bitach
+ */
+uint64_t compactState(const PackedState& s, const int cells)
+{
+    if (cells > 16)
+        throw "Zbyt duza ukladanka";
+    uint64_t compact = 0;
+    PackedState it = s;
+    for (int i = 0; i < cells; ++i, it = it >> PACKED_BITS)
+        compact |= (it.lo & 0xF) << (4 * i);
+    return compact;
+}
+
+/**
+ * \brief Test wydajnoci wspbienej listy zamknitej dla 1..maxThreads wtkw.
+ * Kady wtek wykonuje losowe spacery od rozwizania, wic stany blisko korzenia s wsplne dla wszystkich wtkw.
+ * \param goal Rozwizanie (do 4x4)
+ * \param maxThreads Maksymalna liczba wtkw
+ * \param walks Liczba spacerw na wtek
+ * \param length Dugo spaceru
+ */
+void benchmarkConcurrentClosed(const vector<vector<int>>& goal, const int maxThreads, const int walks, const int length)
+{
+    const int rows = goal.size();
+    const int columns = goal[0].size();
+    const PackedNode start = packBoard(goal);
+    const vector<int> x = { 1,-1,0,0 };
+    const vector<int> y = { 0,0,1,-1 };
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        ConcurrentHashMap closed = ConcurrentHashMap::FromMemoryBudget(static_cast<size_t>(threads) * walks * length * 32);
+        atomic<uint64_t> improved = 0;
+        const auto begin = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]
+            {
+                mt19937 rng(t + 1);
+                PackedNode neighbors[4];
+                uint64_t local = 0;
+                for (int w = 0; w < walks; ++w)
+                {
+                    PackedNode node = start;
+                    for (int step = 1; step <= length; ++step)
+                    {
+                        const int count = getPackedNeighbors(node, rows, columns, x, y, neighbors);
+                        node = neighbors[uniform_int_distribution<int>(0, count - 1)(rng)];
+                        if (closed.InsertIfBetter(compactState(node.state, rows * columns), step, node.blank) == InsertResult::Improved)
+                            local++;
+                    }
+                }
+                improved += local;
+            });
+        }
+        for (auto& w : workers)
+            w.join();
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        const double operations = static_cast<double>(threads) * walks * length;
+        cout << "Threads: " << threads << "\tMops/s: " << operations / seconds / 1e6
+            << "\tStates: " << closed.Size() << "\tImproved: " << improved << endl;
+    }
+}
+
+#pragma endregion
+
+int main(int argc, char* argv[])
+{
+	int V = 6;
+	bool directed = true;
+    const string labels[] = { "S", "A", "B", "C", "D", "G" };
+	Graph* g = makeGraph(V, directed, true, labels);
+
+	addEdge(g, 0, 1, 1); // S -> A
+	addEdge(g, 0, 5, 10); // S -> G
+	addEdge(g, 1, 2, 2); // A -> B
+	addEdge(g, 1, 3, 1); // A -> C
+	addEdge(g, 2, 4, 5); // B -> D
 	addEdge(g, 3, 4, 3); // C -> D
 	addEdge(g, 3, 5, 4); // C -> G
 	addEdge(g, 4, 5, 2); // D -> G
@@ -1017,6 +2537,10 @@ int main()
     Path p = AStarF(g, heuristic, 0, 5);
     printPath(p, true);
 
+    // Pomiar listy zamknitej (do 64 wtkw) tylko na danie: AStar --benchmark
+    if (argc > 1 && string(argv[1]) == "--benchmark")
+        benchmarkConcurrentClosed({ {1,2,3},{4,5,6},{7,8,0} }, 64, 2000, 50);
+
     //int V = 7;
     //bool directed = true;
     //Graph* g = makeGraph(V, directed);
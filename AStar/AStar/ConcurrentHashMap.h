@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * \brief Wynik wstawienia do wspbienej listy zamknitej
+ */
+enum class InsertResult
+{
+	/**
+	 * \brief Stan dodany po raz pierwszy
+	 */
+	Inserted,
+
+	/**
+	 * \brief Stan istnia, koszt zosta poprawiony
+	 */
+	Improved,
+
+	/**
+	 * \brief Stan istnia z kosztem nie gorszym
+	 */
+	Rejected,
+
+	/**
+	 * \brief Brak wolnego miejsca w tablicy
+	 */
+	Full
+};
+
+/**
+ * \brief Bezblokadowa tablica z adresowaniem otwartym dla stanw spakowanych w 64 bitach.
+ * Warto przechowuje koszt g (starsze 32 bity) i dane uytkownika (modsze 32 bity), np. numer ruchu.
+ */
+class ConcurrentHashMap
+{
+	/**
+	 * \brief Klucz wolnej komrki
+	 */
+	static constexpr uint64_t EMPTY = ~0ull;
+
+	/**
+	 * \brief Komrka tablicy
+	 */
+	struct alignas(16) Slot
+	{
+		/**
+		 * \brief Klucz
+		 */
+		std::atomic<uint64_t> key;
+
+		/**
+		 * \brief Koszt i dane uytkownika
+		 */
+		std::atomic<uint64_t> value;
+	};
+
+	/**
+	 * \brief Komrki
+	 */
+	std::unique_ptr<Slot[]> slots;
+
+	/**
+	 * \brief Maska indeksu (pojemno - 1)
+	 */
+	std::size_t mask;
+
+	/**
+	 * \brief Liczba zajtych komrek
+	 */
+	std::atomic<std::size_t> count{ 0 };
+
+	/**
+	 * \brief Mieszanie klucza
+	 * \param key Klucz
+	 * \return Skrt
+	 */
+	static uint64_t Mix(uint64_t key)
+	{
+		key ^= key >> 33;
+		key *= 0xFF51AFD7ED558CCDull;
+		key ^= key >> 33;
+		key *= 0xC4CEB9FE1A85EC53ull;
+		key ^= key >> 33;
+		return key;
+	}
+
+	/**
+	 * \brief Zoenie wartoci z kosztu i danych
+	 * \param g Koszt dojcia
+	 * \param data Dane uytkownika
+	 * \return Warto komrki
+	 */
+	static uint64_t Compose(const uint32_t g, const uint32_t data)
+	{
+		return static_cast<uint64_t>(g) << 32 | data;
+	}
+
+public:
+	/**
+	 * \brief Konstruktor
+	 * \param capacity Minimalna liczba komrek (zaokrglana w gr do potgi dwjki)
+	 */
+	explicit ConcurrentHashMap(const std::size_t capacity)
+	{
+		std::size_t size = 16;
+		while (size < capacity)
+			size <<= 1;
+		slots = std::make_unique<Slot[]>(size);
+		mask = size - 1;
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			slots[i].key.store(EMPTY, std::memory_order_relaxed);
+			slots[i].value.store(~0ull, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * \brief Utworzenie tablicy o rozmiarze wynikajcym z limitu pamici
+	 * \param bytes Limit pamici w bajtach
+	 * \return Tablica
+	 */
+	static ConcurrentHashMap FromMemoryBudget(const std::size_t bytes)
+	{
+		std::size_t size = 16;
+		while (size * 2 * sizeof(Slot) <= bytes)
+			size <<= 1;
+		return ConcurrentHashMap(size);
+	}
+
+	/**
+	 * \brief Konstruktor przenoszcy (tylko przed wspbienym uyciem)
+	 * \param other Tablica rdowa
+	 */
+	ConcurrentHashMap(ConcurrentHashMap&& other) noexcept
+		: slots(std::move(other.slots)), mask(other.mask), count(other.count.load())
+	{
+	}
+
+	/**
+	 * \brief Wstawienie stanu lub poprawa jego kosztu, jeli nowy koszt jest mniejszy
+	 * \param key Stan spakowany (rny od ~0)
+	 * \param g Koszt dojcia
+	 * \param data Dane uytkownika
+	 * \return Wynik wstawienia
+	 */
+	InsertResult InsertIfBetter(const uint64_t key, const uint32_t g, const uint32_t data = 0)
+	{
+		const uint64_t desired = Compose(g, data);
+		std::size_t i = Mix(key) & mask;
+		for (std::size_t probes = 0; probes <= mask; ++probes, i = (i + 1) & mask)
+		{
+			uint64_t current = slots[i].key.load(std::memory_order_acquire);
+			if (current == EMPTY)
+			{
+				if (slots[i].key.compare_exchange_strong(current, key, std::memory_order_acq_rel))
+				{
+					count.fetch_add(1, std::memory_order_relaxed);
+					current = key;
+				}
+				// Przy porace current zawiera klucz wstawiony przez inny wtek
+			}
+			if (current != key)
+				continue;
+
+			// Warto pocztkowa ~0 jest gorsza od kadego kosztu, wic pierwsze wstawienie te przechodzi przez CAS
+			uint64_t value = slots[i].value.load(std::memory_order_acquire);
+			while (desired >> 32 < value >> 32)
+			{
+				const bool fresh = value == ~0ull;
+				if (slots[i].value.compare_exchange_weak(value, desired, std::memory_order_acq_rel))
+					return fresh ? InsertResult::Inserted : InsertResult::Improved;
+			}
+			return InsertResult::Rejected;
+		}
+		return InsertResult::Full;
+	}
+
+	/**
+	 * \brief Odczyt kosztu stanu
+	 * \param key Stan spakowany
+	 * \param g Koszt dojcia (wyjcie)
+	 * \param data Dane uytkownika (wyjcie)
+	 * \return Prawda, jeli stan wystpuje w tablicy
+	 */
+	bool Find(const uint64_t key, uint32_t& g, uint32_t& data) const
+	{
+		std::size_t i = Mix(key) & mask;
+		for (std::size_t probes = 0; probes <= mask; ++probes, i = (i + 1) & mask)
+		{
+			const uint64_t current = slots[i].key.load(std::memory_order_acquire);
+			if (current == EMPTY)
+				return false;
+			if (current == key)
+			{
+				const uint64_t value = slots[i].value.load(std::memory_order_acquire);
+				if (value == ~0ull)
+					return false;
+				g = static_cast<uint32_t>(value >> 32);
+				data = static_cast<uint32_t>(value);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * \brief Liczba zapisanych stanw
+	 * \return Liczba stanw
+	 */
+	[[nodiscard]] std::size_t Size() const
+	{
+		return count.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * \brief Pojemno tablicy
+	 * \return Liczba komrek
+	 */
+	[[nodiscard]] std::size_t Capacity() const
+	{
+		return mask + 1;
+	}
+};
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <vector>
+
+/**
+ * \brief Koncepcja dziedziny przeszukiwania: stan rozpakowany, stan spakowany, skrt, nastpniki i heurystyka
+ */
+template <typename D>
+concept SearchDomain = requires(const D& domain, const typename D::State& state, const typename D::Packed& packed)
+{
+	typename D::State;
+	typename D::Packed;
+	{ domain.Pack(state) } -> std::same_as<typename D::Packed>;
+	{ domain.Unpack(packed) } -> std::same_as<typename D::State>;
+	{ domain.Hash(packed) } -> std::convertible_to<std::size_t>;
+	{ domain.Heuristic(packed) } -> std::convertible_to<int>;
+	{ domain.IsGoal(packed) } -> std::convertible_to<bool>;
+	{ packed == packed } -> std::convertible_to<bool>;
+	domain.Successors(packed, [](const typename D::Packed&, int) {});
+};
+
+/**
+ * \brief Element listy otwartej
+ * \tparam P Stan spakowany
+ */
+template <typename P>
+struct OpenEntry
+{
+	/**
+	 * \brief Stan
+	 */
+	P state;
+
+	/**
+	 * \brief Koszt dojcia
+	 */
+	int g;
+
+	/**
+	 * \brief Oszacowanie kosztu cakowitego
+	 */
+	int f;
+};
+
+/**
+ * \brief Wpis listy zamknitej
+ * \tparam P Stan spakowany
+ */
+template <typename P>
+struct ClosedRecord
+{
+	/**
+	 * \brief Stan poprzedni
+	 */
+	P parent;
+
+	/**
+	 * \brief Najlepszy znany koszt dojcia
+	 */
+	int g;
+};
+
+/**
+ * \brief Lista otwarta oparta na kopcu binarnym
+ * \tparam P Stan spakowany
+ */
+template <typename P>
+class HeapOpenList
+{
+	/**
+	 * \brief Komparator: mniejsze f, przy remisie wiksze g
+	 */
+	struct Compare
+	{
+		/**
+		 * \brief Porwnanie elementw
+		 * \param a Pierwszy element
+		 * \param b Drugi element
+		 * \return Prawda, jeli a ma niszy priorytet ni b
+		 */
+		bool operator()(const OpenEntry<P>& a, const OpenEntry<P>& b) const
+		{
+			return a.f != b.f ? a.f > b.f : a.g < b.g;
+		}
+	};
+
+	/**
+	 * \brief Kopiec
+	 */
+	std::priority_queue<OpenEntry<P>, std::vector<OpenEntry<P>>, Compare> heap;
+
+public:
+	/**
+	 * \brief Dodanie elementu
+	 * \param entry Element
+	 */
+	void Push(const OpenEntry<P>& entry)
+	{
+		heap.push(entry);
+	}
+
+	/**
+	 * \brief Sprawdzenie czy lista jest pusta
+	 * \return Prawda, jeli lista jest pusta
+	 */
+	[[nodiscard]] bool Empty() const
+	{
+		return heap.empty();
+	}
+
+	/**
+	 * \brief Zdjcie elementu o najmniejszym f
+	 * \return Element
+	 */
+	OpenEntry<P> Pop()
+	{
+		OpenEntry<P> top = heap.top();
+		heap.pop();
+		return top;
+	}
+};
+
+/**
+ * \brief Lista otwarta kubekowa dla cakowitych kosztw (kube na kad warto f, LIFO w kubeku)
+ * \tparam P Stan spakowany
+ */
+template <typename P>
+class BucketOpenList
+{
+	/**
+	 * \brief Kubeki indeksowane wartoci f
+	 */
+	std::vector<std::vector<OpenEntry<P>>> buckets;
+
+	/**
+	 * \brief Najmniejsze f, ktre moe by niepuste
+	 */
+	std::size_t minimum = 0;
+
+	/**
+	 * \brief Liczba elementw
+	 */
+	std::size_t count = 0;
+
+public:
+	/**
+	 * \brief Dodanie elementu
+	 * \param entry Element
+	 */
+	void Push(const OpenEntry<P>& entry)
+	{
+		const std::size_t f = static_cast<std::size_t>(entry.f);
+		if (f >= buckets.size())
+			buckets.resize(f + 1);
+		buckets[f].push_back(entry);
+		minimum = std::min(minimum, f);
+		count++;
+	}
+
+	/**
+	 * \brief Sprawdzenie czy lista jest pusta
+	 * \return Prawda, jeli lista jest pusta
+	 */
+	[[nodiscard]] bool Empty() const
+	{
+		return count == 0;
+	}
+
+	/**
+	 * \brief Zdjcie elementu o najmniejszym f
+	 * \return Element
+	 */
+	OpenEntry<P> Pop()
+	{
+		while (buckets[minimum].empty())
+			minimum++;
+		OpenEntry<P> top = buckets[minimum].back();
+		buckets[minimum].pop_back();
+		count--;
+		return top;
+	}
+};
+
+/**
+ * \brief Lista zamknita jako tablica z adresowaniem otwartym i prbkowaniem liniowym
+ * \tparam D Dziedzina przeszukiwania
+ */
+template <SearchDomain D>
+class HashClosedList
+{
+	using P = typename D::Packed;
+
+	/**
+	 * \brief Komrka tablicy
+	 */
+	struct Slot
+	{
+		/**
+		 * \brief Klucz
+		 */
+		P key;
+
+		/**
+		 * \brief Wpis
+		 */
+		ClosedRecord<P> record;
+
+		/**
+		 * \brief Czy komrka zajta
+		 */
+		bool used;
+	};
+
+	/**
+	 * \brief Dziedzina (dostarcza funkcj skrtu)
+	 */
+	const D& domain;
+
+	/**
+	 * \brief Komrki
+	 */
+	std::vector<Slot> slots;
+
+	/**
+	 * \brief Liczba zajtych komrek
+	 */
+	std::size_t count = 0;
+
+	/**
+	 * \brief Wyszukanie komrki klucza lub pierwszej wolnej
+	 * \param key Klucz
+	 * \return Indeks komrki
+	 */
+	[[nodiscard]] std::size_t Probe(const P& key) const
+	{
+		const std::size_t mask = slots.size() - 1;
+		std::size_t i = static_cast<std::size_t>(domain.Hash(key)) & mask;
+		while (slots[i].used && !(slots[i].key == key))
+			i = (i + 1) & mask;
+		return i;
+	}
+
+	/**
+	 * \brief Podwojenie tablicy
+	 */
+	void Grow()
+	{
+		std::vector<Slot> old(slots.size() * 2);
+		old.swap(slots);
+		for (const Slot& s : old)
+			if (s.used)
+				slots[Probe(s.key)] = s;
+	}
+
+public:
+	/**
+	 * \brief Konstruktor
+	 * \param domain Dziedzina
+	 * \param capacity Spodziewana liczba stanw
+	 */
+	explicit HashClosedList(const D& domain, const std::size_t capacity = 1 << 16)
+		: domain(domain)
+	{
+		std::size_t size = 16;
+		while (size < capacity * 2)
+			size <<= 1;
+		slots.resize(size);
+	}
+
+	/**
+	 * \brief Wyszukanie wpisu (wskanik wany do nastpnego wstawienia)
+	 * \param key Klucz
+	 * \return Wpis lub pusty wskanik
+	 */
+	ClosedRecord<P>* Find(const P& key)
+	{
+		Slot& s = slots[Probe(key)];
+		return s.used ? &s.record : nullptr;
+	}
+
+	/**
+	 * \brief Wstawienie lub nadpisanie wpisu
+	 * \param key Klucz
+	 * \param record Wpis
+	 */
+	void Insert(const P& key, const ClosedRecord<P>& record)
+	{
+		if ((count + 1) * 2 > slots.size())
+			Grow();
+		Slot& s = slots[Probe(key)];
+		if (!s.used)
+			count++;
+		s = { key, record, true };
+	}
+};
+
+/**
+ * \brief Lista zamknita oparta na drzewie (wymaga operatora < dla stanu spakowanego)
+ * \tparam D Dziedzina przeszukiwania
+ */
+template <SearchDomain D>
+class MapClosedList
+{
+	using P = typename D::Packed;
+
+	/**
+	 * \brief Drzewo wpisw
+	 */
+	std::map<P, ClosedRecord<P>> records;
+
+public:
+	/**
+	 * \brief Konstruktor
+	 */
+	explicit MapClosedList(const D&, std::size_t = 0)
+	{
+	}
+
+	/**
+	 * \brief Wyszukanie wpisu
+	 * \param key Klucz
+	 * \return Wpis lub pusty wskanik
+	 */
+	ClosedRecord<P>* Find(const P& key)
+	{
+		auto it = records.find(key);
+		return it == records.end() ? nullptr : &it->second;
+	}
+
+	/**
+	 * \brief Wstawienie lub nadpisanie wpisu
+	 * \param key Klucz
+	 * \param record Wpis
+	 */
+	void Insert(const P& key, const ClosedRecord<P>& record)
+	{
+		records[key] = record;
+	}
+};
+
+/**
+ * \brief Wynik przeszukiwania
+ * \tparam S Stan rozpakowany
+ */
+template <typename S>
+struct SearchResult
+{
+	/**
+	 * \brief Stany od pocztkowego do docelowego
+	 */
+	std::vector<S> path;
+
+	/**
+	 * \brief Koszt cieki (-1, gdy brak rozwizania)
+	 */
+	int cost;
+
+	/**
+	 * \brief Liczba rozwinitych stanw
+	 */
+	std::uint64_t expanded;
+};
+
+/**
+ * \brief Algorytm A* dla dowolnej dziedziny speniajcej koncepcj SearchDomain
+ * \tparam D Dziedzina przeszukiwania
+ * \tparam Open Polityka listy otwartej
+ * \tparam Closed Polityka listy zamknitej
+ * \param domain Dziedzina
+ * \param start Stan pocztkowy
+ * \return Wynik przeszukiwania
+ */
+template <SearchDomain D,
+	template <typename> class Open = BucketOpenList,
+	template <typename> class Closed = HashClosedList>
+SearchResult<typename D::State> AStarSearch(const D& domain, const typename D::State& start)
+{
+	using P = typename D::Packed;
+
+	const P initial = domain.Pack(start);
+	Open<P> open;
+	Closed<D> closed(domain);
+	closed.Insert(initial, { initial, 0 });
+	open.Push({ initial, 0, static_cast<int>(domain.Heuristic(initial)) });
+
+	std::uint64_t expanded = 0;
+	while (!open.Empty())
+	{
+		const OpenEntry<P> current = open.Pop();
+		if (closed.Find(current.state)->g < current.g)
+			continue;
+
+		if (domain.IsGoal(current.state))
+		{
+			std::vector<typename D::State> path;
+			P it = current.state;
+			while (!(it == initial))
+			{
+				path.push_back(domain.Unpack(it));
+				it = closed.Find(it)->parent;
+			}
+			path.push_back(domain.Unpack(initial));
+			std::reverse(path.begin(), path.end());
+			return { path, current.g, expanded };
+		}
+
+		expanded++;
+		domain.Successors(current.state, [&](const P& next, const int cost)
+		{
+			const int g = current.g + cost;
+			if (ClosedRecord<P>* record = closed.Find(next))
+			{
+				if (record->g <= g)
+					return;
+				*record = { current.state, g };
+			}
+			else
+				closed.Insert(next, { current.state, g });
+			open.Push({ next, g, g + static_cast<int>(domain.Heuristic(next)) });
+		});
+	}
+	return { std::vector<typename D::State>(), -1, expanded };
+}
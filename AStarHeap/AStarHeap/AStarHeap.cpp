@@ -1,6 +1,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <string.h>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#if defined(__AVX2__) || defined(__SSE4_1__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#include "../../Common/DistanceMatrix.h"
+#include "../../Common/MinHeap.h"
+#include "../../Common/MstTour.h"
 
 struct ListNode
 {
@@ -32,9 +51,9 @@ ListNode* makeListNode(int dest, int weight)
 Graph* makeGraph(int vertices)
 {
     int i;
-    Graph* g = (ListNode*)(sizeof(Graph));
+    Graph* g = (Graph*)malloc(sizeof(Graph));
     g->vertices = vertices;
-    g->array = malloc(sizeof(List) * vertices);
+    g->array = (List*)malloc(sizeof(List) * vertices);
 
     for (i = 0; i < vertices; i++)
     {
@@ -54,191 +73,1860 @@ void addEdge(Graph* g, int src, int dest, int weight)
     g->array[dest].head = node;
 }
 
-struct MinHeapNode
+void printPath(int* parent, int j)
 {
-    int vertices;
-    int dist;
-};
+    if (parent[j] == -1)
+        return;
+
+    printPath(parent, parent[j]);
+
+    printf("%d ", j);
+}
 
-struct MinHeap
+void printSolution(int* dist, int v, int* parent, int src)
 {
-    int size;
-    int capacity;
+    printf("Vertex\t Distance\tPath");
+    for (int i = 0; i < v; i++)
+    {
+        printf("\n%d -> %d \t\t %d\t\t%d ", src, i, dist[i], src);
+        printPath(parent, i);
+    }
+}
+
+void shortestPaths(Graph* g, int src, int* dist, int* parent, int arity = 4)
+{
+    int vertices = g->vertices;
+    int v;
+
+    MinHeap* mh = makeMinHeap(vertices, arity);
+
+    for (v = 0; v < vertices; v++)
+    {
+        parent[v] = -1;
+        dist[v] = INT_MAX;
+    }
+
+    dist[src] = 0;
+    insertMinHeap(mh, src, dist[src]);
+
+    while (!isEmpty(mh))
+    {
+        MinHeapNode mhn = extractMin(mh);
+        int tmp = mhn.vertices;
+
+        ListNode* it = g->array[tmp].head;
+
+        while (it != NULL)
+        {
+            v = it->dest;
+            if (mh->position[v] != EXTRACTED && it->weight + dist[tmp] < dist[v])
+            {
+                parent[v] = tmp;
+                dist[v] = dist[tmp] + it->weight;
+                decrKey(mh, v, dist[v]);
+            }
+            it = it->next;
+        }
+    }
+    freeMinHeap(mh);
+}
+
+struct DynamicPaths
+{
+    Graph* g;
+    int src;
+    int* dist;
+    int* parent;
 
-    int* position;
-    struct MinHeapNode** array;
+    MinHeap* mh;
+    char* affected;
+    std::vector<int> touched;
 };
 
-MinHeapNode* makeMinHeapNode(int vertices, int dist)
+DynamicPaths* makeDynamicPaths(Graph* g, int src)
 {
-    MinHeapNode* mhp = (MinHeapNode*)malloc(sizeof(MinHeapNode));
-    mhp->vertices = vertices;
-    mhp->dist = dist;
-    return mhp;
+    DynamicPaths* dp = new DynamicPaths();
+    dp->g = g;
+    dp->src = src;
+    dp->dist = (int*)malloc(g->vertices * sizeof(int));
+    dp->parent = (int*)malloc(g->vertices * sizeof(int));
+    dp->mh = makeMinHeap(g->vertices);
+    dp->affected = (char*)calloc(g->vertices, sizeof(char));
+    shortestPaths(g, src, dp->dist, dp->parent);
+    return dp;
 }
 
-MinHeap* makeMinHeap(int capacity)
+void freeDynamicPaths(DynamicPaths* dp)
 {
-    MinHeap* mh = (MinHeapNode*)malloc(sizeof(MinHeap));
-    mh->position = malloc(capacity * sizeof(int));
-    mh->size = 0;
-    mh->capacity = capacity;
-    mh->array = malloc(capacity * sizeof(MinHeapNode*));
-    return mh;
+    free(dp->dist);
+    free(dp->parent);
+    freeMinHeap(dp->mh);
+    free(dp->affected);
+    delete dp;
 }
 
-void swap(MinHeapNode** x, MinHeapNode** y)
+void settleQueued(DynamicPaths* dp)
 {
-    MinHeapNode* tmp = *x;
-    *x = *y;
-    *y = tmp;
+    MinHeap* mh = dp->mh;
+    while (!isEmpty(mh))
+    {
+        int u = extractMin(mh).vertices;
+        for (ListNode* it = dp->g->array[u].head; it != NULL; it = it->next)
+        {
+            int v = it->dest;
+            if (dp->dist[u] + it->weight < dp->dist[v])
+            {
+                if (mh->position[v] == NOT_IN_HEAP)
+                    dp->touched.push_back(v);
+                dp->dist[v] = dp->dist[u] + it->weight;
+                dp->parent[v] = u;
+                decrKey(mh, v, dp->dist[v]);
+            }
+        }
+    }
+
+    for (int v : dp->touched)
+        mh->position[v] = NOT_IN_HEAP;
 }
 
-void minHeapify(MinHeap* mh, int idx)
+int relaxInserted(DynamicPaths* dp, int u, int v, int weight)
 {
-    int smallest, left, right;
-    smallest = idx;
-    left = 2 * idx + 1;
-    right = 2 * idx + 2;
+    dp->touched.clear();
+    for (int k = 0; k < 2; k++)
+    {
+        if (dp->dist[u] != INT_MAX && dp->dist[u] + weight < dp->dist[v])
+        {
+            dp->dist[v] = dp->dist[u] + weight;
+            dp->parent[v] = u;
+            dp->touched.push_back(v);
+            decrKey(dp->mh, v, dp->dist[v]);
+        }
+        int tmp = u;
+        u = v;
+        v = tmp;
+    }
+
+    settleQueued(dp);
+    return (int)dp->touched.size();
+}
 
-    if (left < mh->size && mh->array[left]->dist < mh->array[smallest]->dist)
-        smallest = left;
+int repairSubtree(DynamicPaths* dp, int root)
+{
+    Graph* g = dp->g;
+    std::vector<int> subtree(1, root);
+    dp->affected[root] = 1;
+    for (size_t i = 0; i < subtree.size(); i++)
+        for (ListNode* it = g->array[subtree[i]].head; it != NULL; it = it->next)
+            if (dp->parent[it->dest] == subtree[i] && !dp->affected[it->dest])
+            {
+                dp->affected[it->dest] = 1;
+                subtree.push_back(it->dest);
+            }
 
-    if (right < mh->size && mh->array[right]->dist < mh->array[smallest]->dist)
-        smallest = right;
+    std::vector<int> old(subtree.size());
+    for (size_t i = 0; i < subtree.size(); i++)
+    {
+        old[i] = dp->dist[subtree[i]];
+        dp->dist[subtree[i]] = INT_MAX;
+        dp->parent[subtree[i]] = -1;
+    }
 
-    if (smallest != idx)
+    dp->touched.clear();
+    for (int x : subtree)
     {
-        MinHeapNode* smallestNode = mh->array[smallest];
-        MinHeapNode* idxNode = mh->array[idx];
-        mh->position[smallestNode->vertices] = idx;
-        mh->position[idxNode->vertices] = smallest;
-        swap(&mh->array[smallest], &mh->array[idx]);
-        minHeapify(mh, smallest);
+        for (ListNode* it = g->array[x].head; it != NULL; it = it->next)
+        {
+            int y = it->dest;
+            if (!dp->affected[y] && dp->dist[y] != INT_MAX && dp->dist[y] + it->weight < dp->dist[x])
+            {
+                dp->dist[x] = dp->dist[y] + it->weight;
+                dp->parent[x] = y;
+            }
+        }
+        if (dp->dist[x] != INT_MAX)
+        {
+            dp->touched.push_back(x);
+            insertMinHeap(dp->mh, x, dp->dist[x]);
+        }
     }
+    for (int x : subtree)
+        dp->affected[x] = 0;
+
+    settleQueued(dp);
+
+    int changed = 0;
+    for (size_t i = 0; i < subtree.size(); i++)
+        if (dp->dist[subtree[i]] != old[i])
+            changed++;
+    return changed;
 }
 
-int isEmpty(MinHeap* mh)
+ListNode* findEdge(Graph* g, int src, int dest)
 {
-    return mh->size == 0;
+    for (ListNode* it = g->array[src].head; it != NULL; it = it->next)
+        if (it->dest == dest)
+            return it;
+    return NULL;
 }
 
-MinHeapNode* extractMin(MinHeap* mh)
+int dynamicAddEdge(DynamicPaths* dp, int u, int v, int weight)
 {
-    if (isEmpty(mh)) return NULL;
+    addEdge(dp->g, u, v, weight);
+    return relaxInserted(dp, u, v, weight);
+}
 
-    MinHeapNode* root = mh->array[0];
-    MinHeapNode* last = mh->array[mh->size - 1];
-    mh->array[0] = last;
+int dynamicSetWeight(DynamicPaths* dp, int u, int v, int weight)
+{
+    ListNode* forward = findEdge(dp->g, u, v);
+    ListNode* backward = findEdge(dp->g, v, u);
+    if (forward == NULL || backward == NULL)
+        return -1;
 
-    mh->position[root->vertices] = mh->size - 1;
-    mh->position[last->vertices] = 0;
+    int oldWeight = forward->weight;
+    forward->weight = weight;
+    backward->weight = weight;
 
-    --mh->size;
-    minHeapify(mh, 0);
+    if (weight < oldWeight)
+        return relaxInserted(dp, u, v, weight);
+    if (weight == oldWeight)
+        return 0;
 
-    return root;
+    if (dp->parent[v] == u && dp->dist[v] == dp->dist[u] + oldWeight)
+        return repairSubtree(dp, v);
+    if (dp->parent[u] == v && dp->dist[u] == dp->dist[v] + oldWeight)
+        return repairSubtree(dp, u);
+    return 0;
 }
 
-void decrKey(MinHeap* mh, int vertices, int dist)
-{
-    int i = mh->position[vertices];
+const int LANE_INF = INT_MAX / 2;
 
-    mh->array[i]->dist = dist;
-    while (i && mh->array[i]->dist < mh->array[(i - 1) / 2]->dist)
+template <int W>
+int relaxLanes(int* dv, const int* du, int weight)
+{
+    int key = LANE_INF;
+    int l = 0;
+#if defined(__AVX2__)
+    __m256i vw = _mm256_set1_epi32(weight);
+    __m256i vkey = _mm256_set1_epi32(LANE_INF);
+    for (; l + 8 <= W; l += 8)
+    {
+        __m256i cand = _mm256_add_epi32(_mm256_load_si256((const __m256i*)(du + l)), vw);
+        __m256i old = _mm256_load_si256((const __m256i*)(dv + l));
+        __m256i better = _mm256_cmpgt_epi32(old, cand);
+        _mm256_store_si256((__m256i*)(dv + l), _mm256_min_epi32(old, cand));
+        vkey = _mm256_min_epi32(vkey, _mm256_blendv_epi8(_mm256_set1_epi32(LANE_INF), cand, better));
+    }
+    __m128i k4 = _mm_min_epi32(_mm256_castsi256_si128(vkey), _mm256_extracti128_si256(vkey, 1));
+    k4 = _mm_min_epi32(k4, _mm_shuffle_epi32(k4, _MM_SHUFFLE(1, 0, 3, 2)));
+    k4 = _mm_min_epi32(k4, _mm_shuffle_epi32(k4, _MM_SHUFFLE(2, 3, 0, 1)));
+    key = _mm_cvtsi128_si32(k4);
+#endif
+    for (; l < W; l++)
     {
-        mh->position[mh->array[i]->vertices] = (i - 1) / 2;
-        mh->position[mh->array[(i - 1) / 2]->vertices] = i;
-        swap(&mh->array[i], &mh->array[(i - 1) / 2]);
-        i = (i - 1) / 2;
+        int cand = du[l] + weight;
+        if (cand < dv[l])
+        {
+            dv[l] = cand;
+            if (cand < key)
+                key = cand;
+        }
     }
+    return key;
 }
 
-int isInMinHeap(MinHeap* mh, int vertices)
+template <int W>
+void multiSourcePass(Graph* g, const int* sources, int count, int** dist)
 {
-    if (mh->position[vertices] < mh->size)
-        return 1;
-    return 0;
+    int vertices = g->vertices;
+    int* lanes = (int*)operator new[]((size_t)vertices * W * sizeof(int), std::align_val_t(64));
+    for (long long i = 0; i < (long long)vertices * W; i++)
+        lanes[i] = LANE_INF;
+
+    MinHeap* mh = makeMinHeap(vertices);
+    for (int s = 0; s < count; s++)
+    {
+        lanes[(long long)sources[s] * W + s] = 0;
+        if (!isInMinHeap(mh, sources[s]))
+            insertMinHeap(mh, sources[s], 0);
+    }
+
+    while (!isEmpty(mh))
+    {
+        int u = extractMin(mh).vertices;
+        const int* du = lanes + (long long)u * W;
+        for (ListNode* it = g->array[u].head; it != NULL; it = it->next)
+        {
+            int v = it->dest;
+            int key = relaxLanes<W>(lanes + (long long)v * W, du, it->weight);
+            if (key == LANE_INF)
+                continue;
+
+            int i = mh->position[v];
+            if (i < 0 || key < mh->array[i].dist)
+                decrKey(mh, v, key);
+        }
+    }
+    freeMinHeap(mh);
+
+    for (int s = 0; s < count; s++)
+        for (int v = 0; v < vertices; v++)
+        {
+            int d = lanes[(long long)v * W + s];
+            dist[s][v] = d >= LANE_INF ? INT_MAX : d;
+        }
+    operator delete[](lanes, std::align_val_t(64));
 }
 
-void printPath(int* parent, int j)
+void multiSourceShortestPaths(Graph* g, const int* sources, int count, int** dist, int width = 16)
 {
-    if (parent[j] == -1)
-        return;
+    for (int first = 0; first < count; first += width)
+    {
+        int batch = count - first < width ? count - first : width;
+        if (width == 8)
+            multiSourcePass<8>(g, sources + first, batch, dist + first);
+        else
+            multiSourcePass<16>(g, sources + first, batch, dist + first);
+    }
+}
 
-    printPath(parent, parent[j]);
+int findRoot(std::atomic<int>* root, int v)
+{
+    int p = root[v].load(std::memory_order_relaxed);
+    while (p != v)
+    {
+        int gp = root[p].load(std::memory_order_relaxed);
+        if (gp != p)
+            root[v].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+        v = gp;
+        p = root[v].load(std::memory_order_relaxed);
+    }
+    return v;
+}
 
-    printf("%d ", j);
+void uniteRange(Graph* g, std::atomic<int>* root, int t, int threads)
+{
+    for (int v = t; v < g->vertices; v += threads)
+        for (ListNode* it = g->array[v].head; it != NULL; it = it->next)
+        {
+            int a = v;
+            int b = it->dest;
+            for (;;)
+            {
+                a = findRoot(root, a);
+                b = findRoot(root, b);
+                if (a == b)
+                    break;
+                if (a < b)
+                {
+                    int tmp = a;
+                    a = b;
+                    b = tmp;
+                }
+                int expected = a;
+                if (root[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                    break;
+            }
+        }
 }
 
-int printSolution(int* dist, int v, int* parent, int src)
+int* connectedComponents(Graph* g, int* count, int threads = 0)
 {
-    printf("Vertex\t Distance\tPath");
-    for (int i = 0; i < v; i++)
+    int vertices = g->vertices;
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    std::atomic<int>* root = new std::atomic<int>[vertices];
+    for (int v = 0; v < vertices; v++)
+        root[v].store(v, std::memory_order_relaxed);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back(uniteRange, g, root, t, threads);
+    for (std::thread& w : workers)
+        w.join();
+
+    int* component = (int*)malloc(vertices * sizeof(int));
+    *count = 0;
+    for (int v = 0; v < vertices; v++)
     {
-        printf("\n%d -> %d \t\t %d\t\t%d ", src, i, dist[i], src);
-        printPath(parent, i);
+        int r = findRoot(root, v);
+        component[v] = r == v ? (*count)++ : component[r];
     }
+    delete[] root;
+    return component;
 }
 
-void dijkstra(Graph* g, int src)
+int shortestDistance(Graph* g, int src, int dest, const int* component = NULL)
 {
-    int vertices = g->vertices;
-    int* dist =(int*) malloc(vertices * sizeof(int));
-    int v;
-    int* parent = (int*)malloc(vertices * sizeof(int));
+    if (component != NULL && component[src] != component[dest])
+        return INT_MAX;
 
+    int vertices = g->vertices;
+    int* dist = (int*)malloc(vertices * sizeof(int));
     MinHeap* mh = makeMinHeap(vertices);
+    for (int v = 0; v < vertices; v++)
+        dist[v] = INT_MAX;
+    dist[src] = 0;
+    insertMinHeap(mh, src, 0);
 
-    for (v = 0; v < vertices; v++)
+    int result = INT_MAX;
+    while (!isEmpty(mh))
     {
-        parent[v] = -1;
-        dist[v] = INT_MAX;
-        mh->array[v] = makeMinHeapNode(v, dist[v]);
-        mh->position[v] = v;
+        MinHeapNode mhn = extractMin(mh);
+        if (mhn.vertices == dest)
+        {
+            result = mhn.dist;
+            break;
+        }
+        for (ListNode* it = g->array[mhn.vertices].head; it != NULL; it = it->next)
+        {
+            int v = it->dest;
+            if (mh->position[v] != EXTRACTED && mhn.dist + it->weight < dist[v])
+            {
+                dist[v] = mhn.dist + it->weight;
+                decrKey(mh, v, dist[v]);
+            }
+        }
     }
 
-    // mh->array[src] = makeMinHeapNode(src, dist[src]);
-    // mh->position[src] = src;
-    dist[src] = 0;
-    decrKey(mh, src, dist[src]);
+    freeMinHeap(mh);
+    free(dist);
+    return result;
+}
 
-    mh->size = v;
+void boundedDijkstra(Graph* g, int src, int budget, int* dist, MinHeap* mh, std::vector<MinHeapNode>& out)
+{
+    out.clear();
+    dist[src] = 0;
+    insertMinHeap(mh, src, 0);
 
     while (!isEmpty(mh))
     {
-        MinHeapNode* mhn = extractMin(mh);
-        int tmp = mhn->vertices;
+        MinHeapNode mhn = extractMin(mh);
+        out.push_back(mhn);
+        for (ListNode* it = g->array[mhn.vertices].head; it != NULL; it = it->next)
+        {
+            int v = it->dest;
+            int d = mhn.dist + it->weight;
+            if (d <= budget && d < dist[v])
+            {
+                dist[v] = d;
+                decrKey(mh, v, d);
+            }
+        }
+    }
 
-        ListNode* it = g->array[tmp].head;
+    for (MinHeapNode& n : out)
+    {
+        dist[n.vertices] = INT_MAX;
+        mh->position[n.vertices] = NOT_IN_HEAP;
+    }
+}
 
-        while (it != NULL)
+MinHeapNode* copyIsochrone(const std::vector<MinHeapNode>& out, int* count)
+{
+    *count = (int)out.size();
+    MinHeapNode* result = (MinHeapNode*)malloc(out.size() * sizeof(MinHeapNode));
+    for (size_t i = 0; i < out.size(); i++)
+        result[i] = out[i];
+    return result;
+}
+
+MinHeapNode* isochrone(Graph* g, int src, int budget, int* count)
+{
+    int* dist = (int*)malloc(g->vertices * sizeof(int));
+    for (int v = 0; v < g->vertices; v++)
+        dist[v] = INT_MAX;
+    MinHeap* mh = makeMinHeap(g->vertices);
+    std::vector<MinHeapNode> out;
+
+    boundedDijkstra(g, src, budget, dist, mh, out);
+
+    freeMinHeap(mh);
+    free(dist);
+    return copyIsochrone(out, count);
+}
+
+void isochroneWorker(Graph* g, const int* sources, int n, int budget, MinHeapNode** results, int* counts, std::atomic<int>* next)
+{
+    int* dist = (int*)malloc(g->vertices * sizeof(int));
+    for (int v = 0; v < g->vertices; v++)
+        dist[v] = INT_MAX;
+    MinHeap* mh = makeMinHeap(g->vertices);
+    std::vector<MinHeapNode> out;
+
+    for (int s = next->fetch_add(1); s < n; s = next->fetch_add(1))
+    {
+        boundedDijkstra(g, sources[s], budget, dist, mh, out);
+        results[s] = copyIsochrone(out, &counts[s]);
+    }
+
+    freeMinHeap(mh);
+    free(dist);
+}
+
+void isochrones(Graph* g, const int* sources, int n, int budget, MinHeapNode** results, int* counts, int threads = 0)
+{
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back(isochroneWorker, g, sources, n, budget, results, counts, &next);
+    for (std::thread& w : workers)
+        w.join();
+}
+
+int* partitionGraph(Graph* g, int parts)
+{
+    int vertices = g->vertices;
+    int* owner = (int*)malloc(vertices * sizeof(int));
+    int* queue = (int*)malloc(vertices * sizeof(int));
+    for (int v = 0; v < vertices; v++)
+        owner[v] = -1;
+
+    int seed = 0;
+    for (int p = 0; p < parts; p++)
+    {
+        int target = (int)((long long)vertices * (p + 1) / parts - (long long)vertices * p / parts);
+        int size = 0;
+        while (size < target)
         {
-            v = it->dest;
-            if (isInMinHeap(mh, v) && dist[tmp] != INT_MAX && it->weight + dist[tmp] < dist[v])
+            while (owner[seed] != -1)
+                seed++;
+
+            int head = 0;
+            int tail = 0;
+            owner[seed] = p;
+            queue[tail++] = seed;
+            size++;
+            while (head < tail && size < target)
             {
-                parent[v] = tmp;
-                dist[v] = dist[tmp] + it->weight;
-                decrKey(mh, v, dist[v]);
+                int u = queue[head++];
+                for (ListNode* it = g->array[u].head; it != NULL && size < target; it = it->next)
+                    if (owner[it->dest] == -1)
+                    {
+                        owner[it->dest] = p;
+                        queue[tail++] = it->dest;
+                        size++;
+                    }
             }
-            it = it->next;
         }
     }
-    printSolution(dist, vertices, parent, src);
+
+    free(queue);
+    return owner;
 }
 
-int main()
+#ifndef _WIN32
+
+struct Relaxation
 {
-    int V = 7;
-    Graph* graph = makeGraph(V);
+    int vertices;
+    int dist;
+    int parent;
+};
 
-    addEdge(graph, 0, 6, 5);
-    addEdge(graph, 6, 4, 12);
-    addEdge(graph, 6, 1, 2);
-    addEdge(graph, 6, 3, 9);
-    addEdge(graph, 1, 4, 8);
-    addEdge(graph, 3, 5, 6);
-    addEdge(graph, 4, 2, 3);
+int writeAll(int fd, const void* data, size_t bytes)
+{
+    const char* p = (const char*)data;
+    while (bytes > 0)
+    {
+        ssize_t n = send(fd, p, bytes, MSG_NOSIGNAL);
+        if (n <= 0)
+            return 0;
+        p += n;
+        bytes -= (size_t)n;
+    }
+    return 1;
+}
 
-    dijkstra(graph, 5);
+int readAll(int fd, void* data, size_t bytes)
+{
+    char* p = (char*)data;
+    while (bytes > 0)
+    {
+        ssize_t n = read(fd, p, bytes);
+        if (n <= 0)
+            return 0;
+        p += n;
+        bytes -= (size_t)n;
+    }
+    return 1;
+}
+
+int sendRelaxations(int fd, const std::vector<Relaxation>& batch, int count)
+{
+    return writeAll(fd, &count, sizeof(int)) && writeAll(fd, batch.data(), batch.size() * sizeof(Relaxation));
+}
+
+int receiveRelaxations(int fd, std::vector<Relaxation>& batch)
+{
+    int count;
+    if (!readAll(fd, &count, sizeof(int)))
+        return -1;
+    batch.resize(count > 0 ? count : 0);
+    if (count > 0 && !readAll(fd, batch.data(), batch.size() * sizeof(Relaxation)))
+        return -1;
+    return count;
+}
+
+int compareRelaxations(const void* a, const void* b)
+{
+    const Relaxation* x = (const Relaxation*)a;
+    const Relaxation* y = (const Relaxation*)b;
+    if (x->vertices != y->vertices)
+        return x->vertices < y->vertices ? -1 : 1;
+    return x->dist < y->dist ? -1 : x->dist > y->dist;
+}
+
+struct Partition
+{
+    int owned;
+    int* global;
+    int* offset;
+    int* dest;
+    int* weight;
+};
+
+Partition* makePartition(Graph* g, const int* owner, int rank)
+{
+    Partition* part = (Partition*)malloc(sizeof(Partition));
+    int owned = 0;
+    int edges = 0;
+    for (int v = 0; v < g->vertices; v++)
+        if (owner[v] == rank)
+        {
+            owned++;
+            for (ListNode* it = g->array[v].head; it != NULL; it = it->next)
+                edges++;
+        }
+
+    part->owned = owned;
+    part->global = (int*)malloc(owned * sizeof(int));
+    part->offset = (int*)malloc((owned + 1) * sizeof(int));
+    part->dest = (int*)malloc(edges * sizeof(int));
+    part->weight = (int*)malloc(edges * sizeof(int));
+
+    int l = 0;
+    int e = 0;
+    for (int v = 0; v < g->vertices; v++)
+        if (owner[v] == rank)
+        {
+            part->global[l] = v;
+            part->offset[l++] = e;
+            for (ListNode* it = g->array[v].head; it != NULL; it = it->next)
+            {
+                part->dest[e] = it->dest;
+                part->weight[e++] = it->weight;
+            }
+        }
+    part->offset[owned] = e;
+    return part;
+}
+
+void freePartition(Partition* part)
+{
+    free(part->global);
+    free(part->offset);
+    free(part->dest);
+    free(part->weight);
+    free(part);
+}
+
+int localIndex(const Partition* part, int v)
+{
+    int lo = 0;
+    int hi = part->owned;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (part->global[mid] < v)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < part->owned && part->global[lo] == v ? lo : -1;
+}
+
+void partitionWorker(const Partition* part, int fd)
+{
+    int owned = part->owned;
+    int* dist = (int*)malloc(owned * sizeof(int));
+    int* parent = (int*)malloc(owned * sizeof(int));
+    for (int l = 0; l < owned; l++)
+    {
+        dist[l] = INT_MAX;
+        parent[l] = -1;
+    }
+
+    MinHeap* mh = makeMinHeap(owned);
+    std::vector<Relaxation> inbox;
+    std::vector<Relaxation> outbox;
+    while (receiveRelaxations(fd, inbox) >= 0)
+    {
+        if (inbox.size() == 1 && inbox[0].vertices < 0)
+            break;
+
+        for (Relaxation& r : inbox)
+        {
+            int l = localIndex(part, r.vertices);
+            if (l >= 0 && r.dist < dist[l])
+            {
+                dist[l] = r.dist;
+                parent[l] = r.parent;
+                decrKey(mh, l, r.dist);
+            }
+        }
+
+        outbox.clear();
+        while (!isEmpty(mh))
+        {
+            int l = extractMin(mh).vertices;
+            mh->position[l] = NOT_IN_HEAP;
+            int u = part->global[l];
+            for (int e = part->offset[l]; e < part->offset[l + 1]; e++)
+            {
+                int d = dist[l] + part->weight[e];
+                int v = localIndex(part, part->dest[e]);
+                if (v < 0)
+                    outbox.push_back({ part->dest[e], d, u });
+                else if (d < dist[v])
+                {
+                    dist[v] = d;
+                    parent[v] = u;
+                    decrKey(mh, v, d);
+                }
+            }
+        }
+
+        if (!outbox.empty())
+        {
+            qsort(outbox.data(), outbox.size(), sizeof(Relaxation), compareRelaxations);
+            size_t unique = 0;
+            for (size_t i = 0; i < outbox.size(); i++)
+                if (unique == 0 || outbox[unique - 1].vertices != outbox[i].vertices)
+                    outbox[unique++] = outbox[i];
+            outbox.resize(unique);
+        }
+        sendRelaxations(fd, outbox, (int)outbox.size());
+    }
+
+    outbox.clear();
+    for (int l = 0; l < owned; l++)
+        if (dist[l] != INT_MAX)
+            outbox.push_back({ part->global[l], dist[l], parent[l] });
+    sendRelaxations(fd, outbox, (int)outbox.size());
+
+    freeMinHeap(mh);
+    free(dist);
+    free(parent);
+}
+
+int distributedShortestPaths(Graph* g, int src, int* dist, int* parent, int parts)
+{
+    int vertices = g->vertices;
+    int* owner = partitionGraph(g, parts);
+    int* fds = (int*)malloc(parts * sizeof(int));
+    pid_t* pids = (pid_t*)malloc(parts * sizeof(pid_t));
+
+    fflush(stdout);
+    for (int p = 0; p < parts; p++)
+    {
+        int pair[2];
+        int spawned = socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0;
+        Partition* part = makePartition(g, owner, p);
+        if (spawned)
+        {
+            pids[p] = fork();
+            if (pids[p] < 0)
+            {
+                close(pair[0]);
+                close(pair[1]);
+                spawned = 0;
+            }
+        }
+        if (!spawned)
+        {
+            for (int q = 0; q < p; q++)
+            {
+                close(fds[q]);
+                waitpid(pids[q], NULL, 0);
+            }
+            freePartition(part);
+            free(owner);
+            free(fds);
+            free(pids);
+            return 0;
+        }
+        if (pids[p] == 0)
+        {
+            close(pair[0]);
+            for (int q = 0; q < p; q++)
+                close(fds[q]);
+            partitionWorker(part, pair[1]);
+            close(pair[1]);
+            _exit(0);
+        }
+        freePartition(part);
+        close(pair[1]);
+        fds[p] = pair[0];
+    }
+
+    std::vector<Relaxation>* route = new std::vector<Relaxation>[parts];
+    std::vector<Relaxation> batch;
+    route[owner[src]].push_back({ src, 0, -1 });
+    int rounds = 0;
+    int pending = 1;
+    int ok = 1;
+    while (ok && pending > 0)
+    {
+        for (int p = 0; p < parts; p++)
+        {
+            ok = ok && sendRelaxations(fds[p], route[p], (int)route[p].size());
+            route[p].clear();
+        }
+
+        pending = 0;
+        for (int p = 0; p < parts && ok; p++)
+        {
+            ok = receiveRelaxations(fds[p], batch) >= 0;
+            for (Relaxation& r : batch)
+                route[owner[r.vertices]].push_back(r);
+            pending += (int)batch.size();
+        }
+        rounds++;
+    }
+
+    for (int v = 0; v < vertices; v++)
+    {
+        dist[v] = INT_MAX;
+        parent[v] = -1;
+    }
+    std::vector<Relaxation> stop(1, { -1, 0, 0 });
+    for (int p = 0; p < parts; p++)
+    {
+        ok = ok && sendRelaxations(fds[p], stop, 1);
+        ok = ok && receiveRelaxations(fds[p], batch) >= 0;
+        for (Relaxation& r : batch)
+        {
+            dist[r.vertices] = r.dist;
+            parent[r.vertices] = r.parent;
+        }
+        close(fds[p]);
+        waitpid(pids[p], NULL, 0);
+    }
+
+    delete[] route;
+    free(owner);
+    free(fds);
+    free(pids);
+    return ok ? rounds : 0;
+}
+
+#endif
+
+auto graphEdges(Graph* g)
+{
+    return [g](int u, auto visit)
+    {
+        for (ListNode* it = g->array[u].head; it != NULL; it = it->next)
+            visit(it->dest, it->weight);
+    };
+}
+
+void primTree(Graph* g, int* parent, int* key)
+{
+    primForest(g->vertices, graphEdges(g), parent, key);
+}
+
+int edgeWeight(Graph* g, int src, int dest)
+{
+    int best = INT_MAX;
+    for (ListNode* it = g->array[src].head; it != NULL; it = it->next)
+        if (it->dest == dest && it->weight < best)
+            best = it->weight;
+    return best;
+}
+
+struct OddPair
+{
+    int u;
+    int v;
+    int weight;
+};
+
+int compareOddPairs(const void* a, const void* b)
+{
+    int x = ((const OddPair*)a)->weight;
+    int y = ((const OddPair*)b)->weight;
+    return (x > y) - (x < y);
+}
+
+int* mstTour(Graph* g, int christofides = 0)
+{
+    int vertices = g->vertices;
+    int* order = (int*)malloc(vertices * sizeof(int));
+    if (!christofides)
+    {
+        std::vector<int> preorder = mstOrder(vertices, graphEdges(g));
+        for (int v = 0; v < vertices; v++)
+            order[v] = preorder[v];
+        return order;
+    }
+
+    int* parent = (int*)malloc(vertices * sizeof(int));
+    int* key = (int*)malloc(vertices * sizeof(int));
+    primTree(g, parent, key);
+
+    std::vector<std::vector<int>> adj(vertices);
+    for (int v = 0; v < vertices; v++)
+        if (parent[v] >= 0)
+        {
+            adj[v].push_back(parent[v]);
+            adj[parent[v]].push_back(v);
+        }
+
+    std::vector<int> odd;
+    for (int v = 0; v < vertices; v++)
+        if (adj[v].size() % 2 == 1)
+            odd.push_back(v);
+
+    std::vector<char> isOdd(vertices, 0);
+    for (int v : odd)
+        isOdd[v] = 1;
+    std::vector<OddPair> pairs;
+    for (int u : odd)
+        for (ListNode* it = g->array[u].head; it != NULL; it = it->next)
+            if (it->dest > u && isOdd[it->dest])
+                pairs.push_back({ u, it->dest, it->weight });
+    if (!pairs.empty())
+        qsort(pairs.data(), pairs.size(), sizeof(OddPair), compareOddPairs);
+
+    std::vector<char> matched(vertices, 0);
+    for (const OddPair& p : pairs)
+        if (!matched[p.u] && !matched[p.v])
+        {
+            matched[p.u] = matched[p.v] = 1;
+            adj[p.u].push_back(p.v);
+            adj[p.v].push_back(p.u);
+        }
+
+    // Greedy pairing, not a minimum-weight matching; odd vertices left without a free odd neighbour
+    // are paired in index order, possibly through edges that are absent from g
+    int pending = -1;
+    for (int v : odd)
+        if (!matched[v])
+        {
+            if (pending < 0)
+                pending = v;
+            else
+            {
+                adj[pending].push_back(v);
+                adj[v].push_back(pending);
+                pending = -1;
+            }
+        }
+
+    char* seen = (char*)calloc(vertices, sizeof(char));
+    int count = 0;
+    std::vector<int> stack;
+    std::vector<int> circuit;
+    std::vector<size_t> next(vertices, 0);
+    for (int root = 0; root < vertices; root++)
+    {
+        if (seen[root])
+            continue;
+
+        circuit.clear();
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            int u = stack.back();
+            if (next[u] == adj[u].size())
+            {
+                circuit.push_back(u);
+                stack.pop_back();
+                continue;
+            }
+            int v = adj[u][next[u]++];
+            std::vector<int>& back = adj[v];
+            for (size_t i = next[v]; i < back.size(); i++)
+                if (back[i] == u)
+                {
+                    back[i] = back[next[v]];
+                    back[next[v]++] = u;
+                    break;
+                }
+            stack.push_back(v);
+        }
+        for (int i = (int)circuit.size() - 1; i >= 0; i--)
+            if (!seen[circuit[i]])
+            {
+                seen[circuit[i]] = 1;
+                order[count++] = circuit[i];
+            }
+    }
+
+    free(seen);
+    free(parent);
+    free(key);
+    return order;
+}
+
+long long tourWeight(Graph* g, const int* order)
+{
+    long long sum = 0;
+    for (int i = 0; i < g->vertices; i++)
+    {
+        int w = edgeWeight(g, order[i], order[(i + 1) % g->vertices]);
+        if (w == INT_MAX)
+            return -1;
+        sum += w;
+    }
+    return sum;
+}
+
+enum QueueType
+{
+    HEAP_QUEUE,
+    RADIX_QUEUE,
+    DIAL_QUEUE
+};
+
+struct RadixHeap
+{
+    unsigned int last;
+    int size;
+    std::vector<MinHeapNode> buckets[33];
+};
+
+int radixBucket(unsigned int x, unsigned int last)
+{
+    unsigned int diff = x ^ last;
+    int b = 0;
+    while (diff)
+    {
+        diff >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void radixPush(RadixHeap* rh, int vertices, int dist)
+{
+    rh->buckets[radixBucket((unsigned int)dist, rh->last)].push_back({ vertices, dist });
+    rh->size++;
+}
+
+MinHeapNode radixPop(RadixHeap* rh)
+{
+    if (rh->buckets[0].empty())
+    {
+        int i = 1;
+        while (rh->buckets[i].empty())
+            i++;
+
+        unsigned int newLast = UINT_MAX;
+        for (MinHeapNode& n : rh->buckets[i])
+            if ((unsigned int)n.dist < newLast)
+                newLast = n.dist;
+        rh->last = newLast;
+
+        for (MinHeapNode& n : rh->buckets[i])
+            rh->buckets[radixBucket((unsigned int)n.dist, rh->last)].push_back(n);
+        rh->buckets[i].clear();
+    }
+
+    MinHeapNode top = rh->buckets[0].back();
+    rh->buckets[0].pop_back();
+    rh->size--;
+    return top;
+}
+
+void radixShortestPaths(Graph* g, int src, int* dist, int* parent)
+{
+    RadixHeap* rh = new RadixHeap();
+    rh->last = 0;
+    rh->size = 0;
+
+    for (int v = 0; v < g->vertices; v++)
+    {
+        parent[v] = -1;
+        dist[v] = INT_MAX;
+    }
+    dist[src] = 0;
+    radixPush(rh, src, 0);
+
+    while (rh->size > 0)
+    {
+        MinHeapNode mhn = radixPop(rh);
+        int tmp = mhn.vertices;
+        if (mhn.dist != dist[tmp])
+            continue;
+
+        for (ListNode* it = g->array[tmp].head; it != NULL; it = it->next)
+        {
+            int v = it->dest;
+            if (it->weight + dist[tmp] < dist[v])
+            {
+                parent[v] = tmp;
+                dist[v] = dist[tmp] + it->weight;
+                radixPush(rh, v, dist[v]);
+            }
+        }
+    }
+    delete rh;
+}
+
+struct DialQueue
+{
+    int range;
+    int size;
+    int cursor;
+    std::vector<MinHeapNode>* buckets;
+};
+
+DialQueue* makeDialQueue(int maxWeight)
+{
+    DialQueue* dq = (DialQueue*)malloc(sizeof(DialQueue));
+    dq->range = maxWeight + 1;
+    dq->size = 0;
+    dq->cursor = 0;
+    dq->buckets = new std::vector<MinHeapNode>[dq->range];
+    return dq;
+}
+
+void freeDialQueue(DialQueue* dq)
+{
+    delete[] dq->buckets;
+    free(dq);
+}
+
+void dialPush(DialQueue* dq, int vertices, int dist)
+{
+    dq->buckets[dist % dq->range].push_back({ vertices, dist });
+    dq->size++;
+}
+
+MinHeapNode dialPop(DialQueue* dq)
+{
+    while (dq->buckets[dq->cursor].empty())
+        dq->cursor = (dq->cursor + 1) % dq->range;
+
+    MinHeapNode top = dq->buckets[dq->cursor].back();
+    dq->buckets[dq->cursor].pop_back();
+    dq->size--;
+    return top;
+}
+
+void dialShortestPaths(Graph* g, int src, int* dist, int* parent)
+{
+    int maxWeight = 1;
+    for (int v = 0; v < g->vertices; v++)
+    {
+        parent[v] = -1;
+        dist[v] = INT_MAX;
+        for (ListNode* it = g->array[v].head; it != NULL; it = it->next)
+            if (it->weight > maxWeight)
+                maxWeight = it->weight;
+    }
+
+    DialQueue* dq = makeDialQueue(maxWeight);
+    dist[src] = 0;
+    dialPush(dq, src, 0);
+
+    while (dq->size > 0)
+    {
+        MinHeapNode mhn = dialPop(dq);
+        int tmp = mhn.vertices;
+        if (mhn.dist != dist[tmp])
+            continue;
+
+        for (ListNode* it = g->array[tmp].head; it != NULL; it = it->next)
+        {
+            int v = it->dest;
+            if (it->weight + dist[tmp] < dist[v])
+            {
+                parent[v] = tmp;
+                dist[v] = dist[tmp] + it->weight;
+                dialPush(dq, v, dist[v]);
+            }
+        }
+    }
+    freeDialQueue(dq);
+}
+
+void shortestPathsWith(Graph* g, int src, int* dist, int* parent, QueueType type, int arity = 4)
+{
+    switch (type)
+    {
+    case RADIX_QUEUE:
+        radixShortestPaths(g, src, dist, parent);
+        break;
+    case DIAL_QUEUE:
+        dialShortestPaths(g, src, dist, parent);
+        break;
+    default:
+        shortestPaths(g, src, dist, parent, arity);
+        break;
+    }
+}
+
+void dijkstra(Graph* g, int src, int arity = 4, QueueType type = HEAP_QUEUE)
+{
+    int vertices = g->vertices;
+    int* dist = (int*)malloc(vertices * sizeof(int));
+    int* parent = (int*)malloc(vertices * sizeof(int));
+
+    shortestPathsWith(g, src, dist, parent, type, arity);
+    printSolution(dist, vertices, parent, src);
+
+    free(dist);
+    free(parent);
+}
+
+struct SplitGraph
+{
+    int vertices;
+    int* offsets;
+    int* lightEnd;
+    int* targets;
+    int* weights;
+};
+
+SplitGraph* makeSplitGraph(Graph* g, int delta)
+{
+    int vertices = g->vertices;
+    SplitGraph* sg = (SplitGraph*)malloc(sizeof(SplitGraph));
+    sg->vertices = vertices;
+    sg->offsets = (int*)malloc((vertices + 1) * sizeof(int));
+    sg->lightEnd = (int*)malloc(vertices * sizeof(int));
+
+    sg->offsets[0] = 0;
+    for (int v = 0; v < vertices; v++)
+    {
+        int degree = 0;
+        for (ListNode* it = g->array[v].head; it != NULL; it = it->next)
+            degree++;
+        sg->offsets[v + 1] = sg->offsets[v] + degree;
+    }
+
+    sg->targets = (int*)malloc(sg->offsets[vertices] * sizeof(int));
+    sg->weights = (int*)malloc(sg->offsets[vertices] * sizeof(int));
+    for (int v = 0; v < vertices; v++)
+    {
+        int light = sg->offsets[v];
+        int heavy = sg->offsets[v + 1];
+        for (ListNode* it = g->array[v].head; it != NULL; it = it->next)
+        {
+            int e = it->weight <= delta ? light++ : --heavy;
+            sg->targets[e] = it->dest;
+            sg->weights[e] = it->weight;
+        }
+        sg->lightEnd[v] = light;
+    }
+    return sg;
+}
+
+void freeSplitGraph(SplitGraph* sg)
+{
+    free(sg->offsets);
+    free(sg->lightEnd);
+    free(sg->targets);
+    free(sg->weights);
+    free(sg);
+}
+
+int autoDelta(Graph* g)
+{
+    long long edges = 0;
+    int maxWeight = 1;
+    for (int v = 0; v < g->vertices; v++)
+    {
+        for (ListNode* it = g->array[v].head; it != NULL; it = it->next)
+        {
+            edges++;
+            if (it->weight > maxWeight)
+                maxWeight = it->weight;
+        }
+    }
+    long long averageDegree = g->vertices > 0 ? edges / g->vertices : 1;
+    int delta = averageDegree > 0 ? (int)(maxWeight / averageDegree) : maxWeight;
+    return delta > 0 ? delta : 1;
+}
+
+unsigned long long packDistance(unsigned int dist, int parent)
+{
+    return (unsigned long long)dist << 32 | (unsigned int)parent;
+}
+
+void deltaStepping(Graph* g, int src, int* dist, int* parent, int delta = 0, int threads = 0)
+{
+    int vertices = g->vertices;
+    if (delta <= 0)
+        delta = autoDelta(g);
+    if (threads <= 0)
+        threads = std::thread::hardware_concurrency() > 0 ? (int)std::thread::hardware_concurrency() : 1;
+
+    SplitGraph* sg = makeSplitGraph(g, delta);
+    std::atomic<unsigned long long>* state = new std::atomic<unsigned long long>[vertices];
+    int* stamp = (int*)malloc(vertices * sizeof(int));
+    for (int v = 0; v < vertices; v++)
+    {
+        state[v].store(packDistance(INT_MAX, -1), std::memory_order_relaxed);
+        stamp[v] = -1;
+    }
+    state[src].store(packDistance(0, -1), std::memory_order_relaxed);
+
+    int maxWeight = 0;
+    for (int e = 0; e < sg->offsets[vertices]; e++)
+        if (sg->weights[e] > maxWeight)
+            maxWeight = sg->weights[e];
+    int slots = maxWeight / delta + 2;
+    std::vector<std::vector<int>> buckets(slots);
+    buckets[0].push_back(src);
+    std::vector<std::vector<int>> local(threads);
+    std::vector<int> frontier;
+    std::vector<int> settled;
+    int current = 0;
+    int round = 0;
+    bool heavy = false;
+    bool done = false;
+
+    auto distanceOf = [&](int v) { return (unsigned int)(state[v].load(std::memory_order_relaxed) >> 32); };
+
+    auto takeBucket = [&](int b)
+    {
+        frontier.clear();
+        round++;
+        std::vector<int> entries;
+        entries.swap(buckets[b % slots]);
+        for (int v : entries)
+        {
+            if (distanceOf(v) / delta == (unsigned int)b && stamp[v] != round)
+            {
+                stamp[v] = round;
+                frontier.push_back(v);
+                settled.push_back(v);
+            }
+        }
+    };
+
+    auto nextPhase = [&]() noexcept
+    {
+        for (std::vector<int>& l : local)
+        {
+            for (int v : l)
+                buckets[distanceOf(v) / delta % slots].push_back(v);
+            l.clear();
+        }
+
+        if (!heavy)
+        {
+            takeBucket(current);
+            if (!frontier.empty())
+                return;
+            heavy = true;
+            round++;
+            frontier.clear();
+            for (int v : settled)
+            {
+                if (stamp[v] != round)
+                {
+                    stamp[v] = round;
+                    frontier.push_back(v);
+                }
+            }
+            settled.clear();
+            return;
+        }
+
+        heavy = false;
+        int scanned = 0;
+        do
+            current++;
+        while (++scanned < slots && buckets[current % slots].empty());
+        if (buckets[current % slots].empty())
+        {
+            done = true;
+            return;
+        }
+        takeBucket(current);
+    };
+
+    takeBucket(0);
+    std::barrier sync(threads, nextPhase);
+
+    auto worker = [&](int t)
+    {
+        while (!done)
+        {
+            size_t chunk = (frontier.size() + threads - 1) / threads;
+            size_t begin = t * chunk < frontier.size() ? t * chunk : frontier.size();
+            size_t end = begin + chunk < frontier.size() ? begin + chunk : frontier.size();
+            for (size_t i = begin; i < end; i++)
+            {
+                int u = frontier[i];
+                unsigned int du = distanceOf(u);
+                int first = heavy ? sg->lightEnd[u] : sg->offsets[u];
+                int last = heavy ? sg->offsets[u + 1] : sg->lightEnd[u];
+                for (int e = first; e < last; e++)
+                {
+                    int v = sg->targets[e];
+                    unsigned long long desired = packDistance(du + sg->weights[e], u);
+                    unsigned long long old = state[v].load(std::memory_order_relaxed);
+                    while ((desired >> 32) < (old >> 32))
+                    {
+                        if (state[v].compare_exchange_weak(old, desired, std::memory_order_relaxed))
+                        {
+                            local[t].push_back(v);
+                            break;
+                        }
+                    }
+                }
+            }
+            sync.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& th : pool)
+        th.join();
+
+    for (int v = 0; v < vertices; v++)
+    {
+        unsigned long long s = state[v].load(std::memory_order_relaxed);
+        dist[v] = (int)(s >> 32);
+        parent[v] = (int)(unsigned int)s;
+    }
+
+    delete[] state;
+    free(stamp);
+    freeSplitGraph(sg);
+}
+
+int verifyShortestPaths(Graph* g, int src, int* dist)
+{
+    int vertices = g->vertices;
+    int* expected = (int*)malloc(vertices * sizeof(int));
+    int* parent = (int*)malloc(vertices * sizeof(int));
+    shortestPaths(g, src, expected, parent);
+
+    int mismatches = 0;
+    for (int v = 0; v < vertices; v++)
+    {
+        if (expected[v] != dist[v])
+            mismatches++;
+    }
+
+    free(expected);
+    free(parent);
+    return mismatches;
+}
+
+const int APSP_INF = INT_MAX / 2;
+const int APSP_BLOCK = 64;
+
+void dijkstraRows(Graph* g, int* matrix, std::atomic<int>* next)
+{
+    int vertices = g->vertices;
+    int* parent = (int*)malloc(vertices * sizeof(int));
+    for (int src = next->fetch_add(1); src < vertices; src = next->fetch_add(1))
+        shortestPaths(g, src, matrix + (long long)src * vertices, parent);
+    free(parent);
+}
+
+void dijkstraMatrix(Graph* g, int* matrix, int threads)
+{
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back(dijkstraRows, g, matrix, &next);
+    for (std::thread& w : workers)
+        w.join();
+}
+
+void relaxBlock(int* matrix, int n, int ib, int jb, int kb)
+{
+    int iEnd = ib + APSP_BLOCK < n ? ib + APSP_BLOCK : n;
+    int jEnd = jb + APSP_BLOCK < n ? jb + APSP_BLOCK : n;
+    int kEnd = kb + APSP_BLOCK < n ? kb + APSP_BLOCK : n;
+
+    for (int k = kb; k < kEnd; k++)
+    {
+        const int* rowK = matrix + (long long)k * n;
+        for (int i = ib; i < iEnd; i++)
+        {
+            int* rowI = matrix + (long long)i * n;
+            int dik = rowI[k];
+            if (dik >= APSP_INF)
+                continue;
+
+            int j = jb;
+#if defined(__AVX2__)
+            __m256i vik = _mm256_set1_epi32(dik);
+            for (; j + 8 <= jEnd; j += 8)
+            {
+                __m256i vkj = _mm256_loadu_si256((const __m256i*)(rowK + j));
+                __m256i vij = _mm256_loadu_si256((const __m256i*)(rowI + j));
+                _mm256_storeu_si256((__m256i*)(rowI + j), _mm256_min_epi32(vij, _mm256_add_epi32(vik, vkj)));
+            }
+#elif defined(__SSE4_1__) || defined(__AVX__)
+            __m128i vik = _mm_set1_epi32(dik);
+            for (; j + 4 <= jEnd; j += 4)
+            {
+                __m128i vkj = _mm_loadu_si128((const __m128i*)(rowK + j));
+                __m128i vij = _mm_loadu_si128((const __m128i*)(rowI + j));
+                _mm_storeu_si128((__m128i*)(rowI + j), _mm_min_epi32(vij, _mm_add_epi32(vik, vkj)));
+            }
+#endif
+            for (; j < jEnd; j++)
+                if (dik + rowK[j] < rowI[j])
+                    rowI[j] = dik + rowK[j];
+        }
+    }
+}
+
+void relaxBlocks(int* matrix, int n, int kb, int phase, int t, int threads)
+{
+    int blocks = (n + APSP_BLOCK - 1) / APSP_BLOCK;
+    int kIdx = kb / APSP_BLOCK;
+    int count = phase == 2 ? blocks : blocks * blocks;
+
+    for (int b = t; b < count; b += threads)
+    {
+        if (phase == 2)
+        {
+            if (b == kIdx)
+                continue;
+            relaxBlock(matrix, n, kb, b * APSP_BLOCK, kb);
+            relaxBlock(matrix, n, b * APSP_BLOCK, kb, kb);
+        }
+        else
+        {
+            int bi = b / blocks;
+            int bj = b % blocks;
+            if (bi == kIdx || bj == kIdx)
+                continue;
+            relaxBlock(matrix, n, bi * APSP_BLOCK, bj * APSP_BLOCK, kb);
+        }
+    }
+}
+
+void floydWarshallMatrix(Graph* g, int* matrix, int threads)
+{
+    int n = g->vertices;
+    for (long long i = 0; i < (long long)n * n; i++)
+        matrix[i] = APSP_INF;
+    for (int v = 0; v < n; v++)
+    {
+        matrix[(long long)v * n + v] = 0;
+        for (ListNode* it = g->array[v].head; it != NULL; it = it->next)
+            if (it->weight < matrix[(long long)v * n + it->dest])
+                matrix[(long long)v * n + it->dest] = it->weight;
+    }
+
+    for (int kb = 0; kb < n; kb += APSP_BLOCK)
+    {
+        relaxBlock(matrix, n, kb, kb, kb);
+        for (int phase = 2; phase <= 3; phase++)
+        {
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++)
+                workers.emplace_back(relaxBlocks, matrix, n, kb, phase, t, threads);
+            for (std::thread& w : workers)
+                w.join();
+        }
+    }
+
+    for (long long i = 0; i < (long long)n * n; i++)
+        if (matrix[i] >= APSP_INF)
+            matrix[i] = INT_MAX;
+}
+
+int* allPairsDistances(Graph* g, int threads = 0)
+{
+    int n = g->vertices;
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    long long edges = 0;
+    for (int v = 0; v < n; v++)
+        for (ListNode* it = g->array[v].head; it != NULL; it = it->next)
+            edges++;
+
+    int* matrix = (int*)malloc((long long)n * n * sizeof(int));
+    if (edges * 8 >= (long long)n * n)
+        floydWarshallMatrix(g, matrix, threads);
+    else
+        dijkstraMatrix(g, matrix, threads);
+    return matrix;
+}
+
+void brandesWorker(Graph* g, const int* sources, int count, std::atomic<int>* next, double* centrality)
+{
+    int vertices = g->vertices;
+    int* dist = (int*)malloc(vertices * sizeof(int));
+    double* sigma = (double*)malloc(vertices * sizeof(double));
+    double* delta = (double*)malloc(vertices * sizeof(double));
+    int* order = (int*)malloc(vertices * sizeof(int));
+    MinHeap* mh = makeMinHeap(vertices);
+
+    for (int s = next->fetch_add(1); s < count; s = next->fetch_add(1))
+    {
+        int src = sources[s];
+        for (int v = 0; v < vertices; v++)
+        {
+            dist[v] = INT_MAX;
+            sigma[v] = 0;
+            delta[v] = 0;
+            mh->position[v] = NOT_IN_HEAP;
+        }
+        dist[src] = 0;
+        sigma[src] = 1;
+        insertMinHeap(mh, src, 0);
+
+        int settled = 0;
+        while (!isEmpty(mh))
+        {
+            int u = extractMin(mh).vertices;
+            order[settled++] = u;
+            for (ListNode* it = g->array[u].head; it != NULL; it = it->next)
+            {
+                int v = it->dest;
+                int d = dist[u] + it->weight;
+                if (d < dist[v])
+                {
+                    dist[v] = d;
+                    sigma[v] = sigma[u];
+                    decrKey(mh, v, d);
+                }
+                else if (d == dist[v] && mh->position[v] != EXTRACTED)
+                    sigma[v] += sigma[u];
+            }
+        }
+
+        for (int i = settled - 1; i > 0; i--)
+        {
+            int w = order[i];
+            for (ListNode* it = g->array[w].head; it != NULL; it = it->next)
+            {
+                int v = it->dest;
+                if (dist[v] != INT_MAX && dist[v] + it->weight == dist[w] && v != w)
+                    delta[v] += sigma[v] / sigma[w] * (1 + delta[w]);
+            }
+            centrality[w] += delta[w];
+        }
+    }
+
+    freeMinHeap(mh);
+    free(dist);
+    free(sigma);
+    free(delta);
+    free(order);
+}
+
+double* betweenness(Graph* g, int threads = 0, int samples = 0, unsigned int seed = 1)
+{
+    int vertices = g->vertices;
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    int count = samples > 0 && samples < vertices ? samples : vertices;
+    int* sources = (int*)malloc(vertices * sizeof(int));
+    for (int v = 0; v < vertices; v++)
+        sources[v] = v;
+    if (count < vertices)
+    {
+        srand(seed);
+        for (int i = 0; i < count; i++)
+        {
+            int j = i + (int)(((long long)rand() * (RAND_MAX + 1LL) + rand()) % (vertices - i));
+            int tmp = sources[i];
+            sources[i] = sources[j];
+            sources[j] = tmp;
+        }
+    }
+
+    double* partial = (double*)calloc((size_t)threads * vertices, sizeof(double));
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back(brandesWorker, g, sources, count, &next, partial + (size_t)t * vertices);
+    for (std::thread& w : workers)
+        w.join();
+
+    double scale = 0.5 * vertices / count;
+    double* centrality = (double*)malloc(vertices * sizeof(double));
+    for (int v = 0; v < vertices; v++)
+    {
+        double sum = 0;
+        for (int t = 0; t < threads; t++)
+            sum += partial[(size_t)t * vertices + v];
+        centrality[v] = sum * scale;
+    }
+
+    free(partial);
+    free(sources);
+    return centrality;
+}
+
+Graph* makeRandomGraph(int vertices, int edgesPerVertex, int maxWeight, unsigned int seed)
+{
+    Graph* g = makeGraph(vertices);
+    srand(seed);
+    for (int v = 1; v < vertices; v++)
+        addEdge(g, v - 1, v, 1 + rand() % maxWeight);
+    for (long long e = 0; e < (long long)vertices * (edgesPerVertex - 1); e++)
+    {
+        int a = (int)(((long long)rand() * (RAND_MAX + 1LL) + rand()) % vertices);
+        int b = (int)(((long long)rand() * (RAND_MAX + 1LL) + rand()) % vertices);
+        addEdge(g, a, b, 1 + rand() % maxWeight);
+    }
+    return g;
+}
+
+void freeGraph(Graph* g)
+{
+    for (int v = 0; v < g->vertices; v++)
+    {
+        ListNode* it = g->array[v].head;
+        while (it != NULL)
+        {
+            ListNode* next = it->next;
+            free(it);
+            it = next;
+        }
+    }
+    free(g->array);
+    free(g);
+}
+
+void benchmarkQueues(int vertices, int edgesPerVertex)
+{
+    const int ranges[] = { 10, 1000000 };
+    const char* names[] = { "binary heap", "4-ary heap", "radix heap", "dial buckets" };
+    int* dist = (int*)malloc(vertices * sizeof(int));
+    int* parent = (int*)malloc(vertices * sizeof(int));
+    int* expected = (int*)malloc(vertices * sizeof(int));
+
+    for (int maxWeight : ranges)
+    {
+        Graph* g = makeRandomGraph(vertices, edgesPerVertex, maxWeight, 42);
+        printf("V = %d, E/V = %d, weights 1..%d\n", vertices, edgesPerVertex, maxWeight);
+        for (int q = 0; q < 4; q++)
+        {
+            QueueType type = q < 2 ? HEAP_QUEUE : q == 2 ? RADIX_QUEUE : DIAL_QUEUE;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            shortestPathsWith(g, 0, q == 0 ? expected : dist, parent, type, q == 0 ? 2 : 4);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            int mismatches = 0;
+            if (q > 0)
+                for (int v = 0; v < vertices; v++)
+                    if (dist[v] != expected[v])
+                        mismatches++;
+            printf("  %-14s %8.3f s  mismatches: %d\n", names[q], seconds, mismatches);
+        }
+        freeGraph(g);
+    }
+
+    free(dist);
+    free(parent);
+    free(expected);
+}
+
+int checkShortestPaths(Graph* g, int src)
+{
+    const QueueType types[] = { HEAP_QUEUE, RADIX_QUEUE, DIAL_QUEUE };
+    int* dist = (int*)malloc(g->vertices * sizeof(int));
+    int* parent = (int*)malloc(g->vertices * sizeof(int));
+
+    int mismatches = 0;
+    for (QueueType type : types)
+    {
+        shortestPathsWith(g, src, dist, parent, type);
+        mismatches += verifyShortestPaths(g, src, dist);
+    }
+    deltaStepping(g, src, dist, parent, 0, 2);
+    mismatches += verifyShortestPaths(g, src, dist);
+#ifndef _WIN32
+    distributedShortestPaths(g, src, dist, parent, 2);
+    mismatches += verifyShortestPaths(g, src, dist);
+#endif
+
+    free(dist);
+    free(parent);
+    return mismatches;
+}
+
+#ifndef _WIN32
+
+void checkDistributedShortestPaths(int vertices, int edgesPerVertex)
+{
+    const int partitions[] = { 1, 2, 3, 4, 8 };
+    Graph* g = makeRandomGraph(vertices, edgesPerVertex, 1000, 7);
+    int* dist = (int*)malloc(vertices * sizeof(int));
+    int* parent = (int*)malloc(vertices * sizeof(int));
+
+    printf("V = %d, E/V = %d, distributed shortest paths\n", vertices, edgesPerVertex);
+    for (int parts : partitions)
+    {
+        int rounds = distributedShortestPaths(g, 0, dist, parent, parts);
+        printf("  %d partitions  rounds: %3d  mismatches: %d\n", parts, rounds, verifyShortestPaths(g, 0, dist));
+    }
+
+    free(dist);
+    free(parent);
+    freeGraph(g);
+}
+
+#endif
+
+int main(int argc, char* argv[])
+{
+    int V = 7;
+    Graph* graph = makeGraph(V);
+
+    addEdge(graph, 0, 6, 5);
+    addEdge(graph, 6, 4, 12);
+    addEdge(graph, 6, 1, 2);
+    addEdge(graph, 6, 3, 9);
+    addEdge(graph, 1, 4, 8);
+    addEdge(graph, 3, 5, 6);
+    addEdge(graph, 4, 2, 3);
+
+    dijkstra(graph, 5);
+    printf("\nmismatches against shortestPaths: %d\n", checkShortestPaths(graph, 5));
+
+    if (argc > 2 && strcmp(argv[1], "--apsp") == 0)
+    {
+        int* matrix = allPairsDistances(graph);
+        if (!writeDistanceMatrix(argv[2], matrix, V))
+            printf("cannot write %s\n", argv[2]);
+        free(matrix);
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+    {
+        printf("\n\n");
+        benchmarkQueues(200000, 8);
+#ifndef _WIN32
+        printf("\n");
+        checkDistributedShortestPaths(20000, 6);
+#endif
+    }
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * \brief Znacznik pliku macierzy odlegoci. Plik zawiera znacznik, liczb wierzchokw n (int)
+ * i n*n wartoci int zapisanych wierszami; INT_MAX oznacza brak poczenia.
+ */
+constexpr char DISTANCE_MATRIX_MAGIC[4] = { 'A', 'P', 'S', 'P' };
+
+/**
+ * \brief Zapis macierzy odlegoci do pliku binarnego
+ * \param file cieka pliku
+ * \param matrix Macierz n x n zapisana wierszami
+ * \param n Liczba wierzchokw
+ * \return 1 przy powodzeniu, 0 przy bdzie zapisu
+ */
+inline int writeDistanceMatrix(const char* file, const int* matrix, int n)
+{
+	FILE* f = fopen(file, "wb");
+	if (f == NULL)
+		return 0;
+
+	int ok = fwrite(DISTANCE_MATRIX_MAGIC, 1, 4, f) == 4
+		&& fwrite(&n, sizeof(int), 1, f) == 1
+		&& fwrite(matrix, sizeof(int), (size_t)n * n, f) == (size_t)n * n;
+	fclose(f);
+	return ok;
+}
+
+/**
+ * \brief Odczyt macierzy odlegoci z pliku binarnego
+ * \param file cieka pliku
+ * \param n Liczba wierzchokw (wyjcie)
+ * \return Macierz n x n przydzielona przez malloc lub NULL przy bdzie
+ */
+inline int* readDistanceMatrix(const char* file, int* n)
+{
+	FILE* f = fopen(file, "rb");
+	if (f == NULL)
+		return NULL;
+
+	char magic[4];
+	int* matrix = NULL;
+	if (fread(magic, 1, 4, f) == 4 && memcmp(magic, DISTANCE_MATRIX_MAGIC, 4) == 0 && fread(n, sizeof(int), 1, f) == 1 && *n > 0)
+	{
+		matrix = (int*)malloc((size_t)*n * *n * sizeof(int));
+		if (matrix != NULL && fread(matrix, sizeof(int), (size_t)*n * *n, f) != (size_t)*n * *n)
+		{
+			free(matrix);
+			matrix = NULL;
+		}
+	}
+	fclose(f);
+	return matrix;
+}
+
+/**
+ * \brief Sprawdzenie czy macierz opisuje graf peny (solwery TSP wymagaj odlegoci midzy kad par wierzchokw)
+ * \param matrix Macierz n x n zapisana wierszami
+ * \param n Liczba wierzchokw
+ * \return 1, jeli poza przektn nie ma wartoci INT_MAX
+ */
+inline int isCompleteMatrix(const int* matrix, int n)
+{
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j < n; j++)
+			if (i != j && matrix[(size_t)i * n + j] == INT_MAX)
+				return 0;
+	return 1;
+}
+
+/**
+ * \brief Przekazanie krawdzi opisanych macierz do funkcji dodajcej krawd
+ * \param matrix Macierz n x n zapisana wierszami
+ * \param n Liczba wierzchokw
+ * \param addEdge Wywoywana jako addEdge(i, j, odlego) dla i != j i odlegoci rnej od INT_MAX
+ */
+template <typename AddEdge>
+inline void forEachMatrixEdge(const int* matrix, int n, AddEdge addEdge)
+{
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j < n; j++)
+			if (i != j && matrix[(size_t)i * n + j] != INT_MAX)
+				addEdge(i, j, matrix[(size_t)i * n + j]);
+}
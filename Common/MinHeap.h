@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdlib>
+
+/**
+ * \brief Element kopca: wierzchoek i jego klucz
+ */
+struct MinHeapNode
+{
+	int vertices;
+	int dist;
+};
+
+/**
+ * \brief Indeksowany kopiec d-arny; position[v] to pozycja wierzchoka v w tablicy,
+ * NOT_IN_HEAP albo EXTRACTED
+ */
+struct MinHeap
+{
+	int size;
+	int capacity;
+	int arity;
+
+	int* position;
+	MinHeapNode* array;
+};
+
+const int NOT_IN_HEAP = -1;
+const int EXTRACTED = -2;
+
+/**
+ * \brief Utworzenie pustego kopca
+ * \param capacity Liczba wierzchokw (klucze 0..capacity-1)
+ * \param arity Stopie kopca: 2, 4 lub 8
+ * \return Kopiec przydzielony przez malloc
+ */
+inline MinHeap* makeMinHeap(int capacity, int arity = 4)
+{
+	MinHeap* mh = (MinHeap*)malloc(sizeof(MinHeap));
+	mh->position = (int*)malloc(capacity * sizeof(int));
+	mh->size = 0;
+	mh->capacity = capacity;
+	mh->arity = arity == 2 || arity == 8 ? arity : 4;
+	mh->array = (MinHeapNode*)malloc(capacity * sizeof(MinHeapNode));
+	for (int i = 0; i < capacity; i++)
+		mh->position[i] = NOT_IN_HEAP;
+	return mh;
+}
+
+inline void freeMinHeap(MinHeap* mh)
+{
+	free(mh->position);
+	free(mh->array);
+	free(mh);
+}
+
+inline void siftUp(MinHeap* mh, int idx)
+{
+	MinHeapNode node = mh->array[idx];
+	while (idx > 0)
+	{
+		int parentIdx = (idx - 1) / mh->arity;
+		if (mh->array[parentIdx].dist <= node.dist)
+			break;
+		mh->array[idx] = mh->array[parentIdx];
+		mh->position[mh->array[idx].vertices] = idx;
+		idx = parentIdx;
+	}
+	mh->array[idx] = node;
+	mh->position[node.vertices] = idx;
+}
+
+inline void minHeapify(MinHeap* mh, int idx)
+{
+	MinHeapNode node = mh->array[idx];
+	for (;;)
+	{
+		int first = mh->arity * idx + 1;
+		if (first >= mh->size)
+			break;
+		int last = first + mh->arity < mh->size ? first + mh->arity : mh->size;
+		int smallest = first;
+		for (int c = first + 1; c < last; c++)
+			if (mh->array[c].dist < mh->array[smallest].dist)
+				smallest = c;
+		if (mh->array[smallest].dist >= node.dist)
+			break;
+		mh->array[idx] = mh->array[smallest];
+		mh->position[mh->array[idx].vertices] = idx;
+		idx = smallest;
+	}
+	mh->array[idx] = node;
+	mh->position[node.vertices] = idx;
+}
+
+inline int isEmpty(MinHeap* mh)
+{
+	return mh->size == 0;
+}
+
+/**
+ * \brief Zdjcie elementu o najmniejszym kluczu; jego pozycja staje si EXTRACTED
+ */
+inline MinHeapNode extractMin(MinHeap* mh)
+{
+	MinHeapNode root = mh->array[0];
+	mh->position[root.vertices] = EXTRACTED;
+
+	--mh->size;
+	if (mh->size > 0)
+	{
+		mh->array[0] = mh->array[mh->size];
+		minHeapify(mh, 0);
+	}
+
+	return root;
+}
+
+inline void insertMinHeap(MinHeap* mh, int vertices, int dist)
+{
+	mh->array[mh->size].vertices = vertices;
+	mh->array[mh->size].dist = dist;
+	siftUp(mh, mh->size++);
+}
+
+/**
+ * \brief Zmniejszenie klucza wierzchoka; wierzchoek spoza kopca jest wstawiany
+ */
+inline void decrKey(MinHeap* mh, int vertices, int dist)
+{
+	int i = mh->position[vertices];
+	if (i < 0)
+	{
+		insertMinHeap(mh, vertices, dist);
+		return;
+	}
+
+	mh->array[i].dist = dist;
+	siftUp(mh, i);
+}
+
+inline int isInMinHeap(MinHeap* mh, int vertices)
+{
+	return mh->position[vertices] >= 0;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <climits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "MinHeap.h"
+
+/**
+ * \brief Las minimalnych drzew rozpinajcych (algorytm Prima na indeksowanym kopcu, O(E log V))
+ * \param vertices Liczba wierzchokw
+ * \param forEachEdge Wywoanie forEachEdge(u, visit) przekazuje kad krawd u -> v jako visit(v, waga)
+ * \param parent Rodzic wierzchoka w drzewie (wyjcie), -1 dla korzeni
+ * \param key Waga krawdzi do rodzica (wyjcie)
+ */
+template <typename Neighbors>
+inline void primForest(int vertices, Neighbors forEachEdge, int* parent, int* key)
+{
+	MinHeap* mh = makeMinHeap(vertices);
+	for (int v = 0; v < vertices; v++)
+	{
+		parent[v] = -1;
+		key[v] = INT_MAX;
+	}
+
+	for (int root = 0; root < vertices; root++)
+	{
+		if (mh->position[root] == EXTRACTED)
+			continue;
+
+		key[root] = 0;
+		insertMinHeap(mh, root, 0);
+		while (!isEmpty(mh))
+		{
+			int u = extractMin(mh).vertices;
+			forEachEdge(u, [&](int v, int weight)
+			{
+				if (v >= 0 && v < vertices && mh->position[v] != EXTRACTED && weight < key[v])
+				{
+					key[v] = weight;
+					parent[v] = u;
+					decrKey(mh, v, weight);
+				}
+			});
+		}
+	}
+	freeMinHeap(mh);
+}
+
+/**
+ * \brief Trasa z minimalnego drzewa rozpinajcego: obejcie lasu z primForest w porzdku preorder,
+ * czyli cykl Eulera podwojonego drzewa ze skrtami. Dla wag speniajcych nierwno trjkta
+ * trasa jest co najwyej dwa razy dusza od optymalnej.
+ * \param vertices Liczba wierzchokw
+ * \param forEachEdge Jak w primForest
+ * \return Wszystkie wierzchoki w kolejnoci odwiedzania
+ */
+template <typename Neighbors>
+inline std::vector<int> mstOrder(int vertices, Neighbors forEachEdge)
+{
+	std::vector<int> parent(vertices);
+	std::vector<int> key(vertices);
+	primForest(vertices, forEachEdge, parent.data(), key.data());
+
+	std::vector<std::vector<int>> children(vertices);
+	for (int v = 0; v < vertices; v++)
+		if (parent[v] >= 0)
+			children[parent[v]].push_back(v);
+
+	std::vector<int> order;
+	order.reserve(vertices);
+	std::vector<int> stack;
+	for (int root = 0; root < vertices; root++)
+	{
+		if (parent[root] >= 0)
+			continue;
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			int u = stack.back();
+			stack.pop_back();
+			order.push_back(u);
+			for (auto it = children[u].rbegin(); it != children[u].rend(); ++it)
+				stack.push_back(*it);
+		}
+	}
+	return order;
+}
+
+/**
+ * \brief mstOrder dla grafu z wzami trzymajcymi list krawdzi (edges, destination, distance), jak w AG i AM
+ * \param nodes Wzy grafu
+ * \return Wzy w kolejnoci odwiedzania
+ */
+template <typename N>
+inline std::vector<N*> mstRoute(const std::vector<N*>& nodes)
+{
+	const int n = static_cast<int>(nodes.size());
+	std::unordered_map<const N*, int> index;
+	for (int i = 0; i < n; i++)
+		index[nodes[i]] = i;
+
+	const std::vector<int> order = mstOrder(n, [&](int u, auto visit)
+	{
+		for (const auto edge : nodes[u]->edges)
+		{
+			const auto it = index.find(edge->destination);
+			if (it != index.end())
+				visit(it->second, static_cast<int>(edge->distance));
+		}
+	});
+
+	std::vector<N*> route;
+	route.reserve(n);
+	for (int v : order)
+		route.push_back(nodes[v]);
+	return route;
+}
+
+/**
+ * \brief Sprawdzenie trasy w grafie jak dla mstRoute: kady wze grafu wystpuje dokadnie raz,
+ * a kolejne wzy (take ostatni i pierwszy) czy krawd
+ * \param nodes Wzy grafu
+ * \param route Trasa bez powtrzonego wza pocztkowego
+ * \return Prawda dla poprawnej trasy
+ */
+template <typename N>
+inline bool isValidRoute(const std::vector<N*>& nodes, const std::vector<N*>& route)
+{
+	if (route.empty() || route.size() != nodes.size())
+		return false;
+
+	std::unordered_set<const N*> unvisited(nodes.begin(), nodes.end());
+	for (size_t i = 0; i < route.size(); i++)
+	{
+		if (unvisited.erase(route[i]) == 0)
+			return false;
+
+		const N* next = route[(i + 1) % route.size()];
+		bool connected = false;
+		for (const auto edge : route[i]->edges)
+			connected = connected || edge->destination == next;
+		if (!connected)
+			return false;
+	}
+	return true;
+}
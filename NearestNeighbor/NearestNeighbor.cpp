@@ -1,4 +1,20 @@
 #include <iostream>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+// SIMD kernels need -mavx2 / -mavx512f (GCC, Clang) or /arch:AVX2 / /arch:AVX512 (MSVC); otherwise the scalar loops are used
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "../Common/DistanceMatrix.h"
 
 using namespace std;
 
@@ -59,114 +75,1971 @@ void addEdge(Graph* g, int src, int dest, int weight) {
     }
 }
 
-Result nearestNeighbor(Graph *g)
+Graph* makeGraphFromMatrix(const int* matrix, int n) {
+    Graph* g = makeGraph(n, true);
+    for (int i = 0; i < n; i++) {
+        for (int j = n - 1; j >= 0; j--) {
+            int w = matrix[(long long)i * n + j];
+            if (i != j && w != INT_MAX) {
+                addEdge(g, i, j, w);
+            }
+        }
+    }
+    return g;
+}
+
+int greedyTour(Graph *g, int start, bool *visited, ListNode **partialOutput)
+{
+    fill_n(visited, g->vertices, false);
+    visited[start] = true;
+    int sum = 0;
+    ListNode *el = g->array[start].head;
+
+    int it = 0;
+    for (int j = 0; j < g->vertices - 1; ++j)
+    {
+        ListNode* candidate = NULL;
+        int weight = INT_MAX;
+        while (el)
+        {
+            if (!visited[el->dest] && el->weight < weight)
+            {
+                weight = el->weight;
+                candidate = el;
+            }
+            el = el->next;
+        }
+
+        if (candidate == NULL)
+            return INT_MAX;
+
+        visited[candidate->dest] = true;
+        sum += weight;
+        el = g->array[candidate->dest].head;
+        partialOutput[it++] = candidate;
+    }
+    while (el)
+    {
+        if (el->dest == start)
+        {
+            partialOutput[it++] = el;
+            return sum + el->weight;
+        }
+        el = el->next;
+    }
+    return INT_MAX;
+}
+
+void nearestNeighborWorker(Graph *g, atomic<int> *next, ListNode **output, int *minSum, int *minStart)
 {
-    Result r;
-    ListNode **output = (ListNode **)calloc(g->vertices, sizeof(ListNode *));
     ListNode **partialOutput = (ListNode **)calloc(g->vertices, sizeof(ListNode *));
-    int minSum = INT_MAX;
     bool *visited = (bool *)calloc(g->vertices, sizeof(bool));
-    for (int i = 0; i < g->vertices; ++i)
-	{
-        visited[i] = true;
-        int sum = 0;
-        ListNode *el = g->array[i].head;
+    for (int i = next->fetch_add(1); i < g->vertices; i = next->fetch_add(1))
+    {
+        int sum = greedyTour(g, i, visited, partialOutput);
+        if (sum < *minSum || (sum == *minSum && sum != INT_MAX && i < *minStart))
+        {
+            memcpy(output, partialOutput, g->vertices * sizeof(ListNode *));
+            *minSum = sum;
+            *minStart = i;
+        }
+    }
+    free(partialOutput);
+    free(visited);
+}
+
+Result nearestNeighbor(Graph *g, int threads = 0)
+{
+    if (threads <= 0)
+        threads = (int)thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    ListNode **buffers = (ListNode **)calloc((size_t)threads * g->vertices, sizeof(ListNode *));
+    vector<int> sums(threads, INT_MAX);
+    vector<int> starts(threads, INT_MAX);
+    atomic<int> next(0);
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back(nearestNeighborWorker, g, &next, buffers + (size_t)t * g->vertices, &sums[t], &starts[t]);
+    for (auto &w : workers)
+        w.join();
 
-        int it = 0;
-        bool looped = true;
+    int best = 0;
+    for (int t = 1; t < threads; ++t)
+        if (sums[t] < sums[best] || (sums[t] == sums[best] && starts[t] < starts[best]))
+            best = t;
+
+    Result r;
+    r.nodes = (ListNode **)calloc(g->vertices, sizeof(ListNode *));
+    memcpy(r.nodes, buffers + (size_t)best * g->vertices, g->vertices * sizeof(ListNode *));
+    r.distance = sums[best];
+    free(buffers);
+    return r;
+}
 
-        for (int j = 0; j < g->vertices - 1; ++j)
+int* graphToMatrix(Graph *g)
+{
+    int n = g->vertices;
+    int *matrix = (int *)malloc((size_t)n * n * sizeof(int));
+    fill_n(matrix, (size_t)n * n, INT_MAX);
+    for (int i = 0; i < n; ++i)
+    {
+        for (ListNode *el = g->array[i].head; el; el = el->next)
         {
-            ListNode* candidate;
-            int weight = INT_MAX;
-            while (el)
-            {
-                if (!visited[el->dest] && el->weight < weight)
-                {
-                    weight = el->weight;
-                    candidate = el;
-                }
-                el = el->next;
-            }
+            if (el->weight < matrix[(size_t)i * n + el->dest])
+                matrix[(size_t)i * n + el->dest] = el->weight;
+        }
+    }
+    return matrix;
+}
 
-            if (weight == INT_MAX)
-                looped = false;
-            
-            visited[candidate->dest] = true;
-            sum += weight;
-            el = g->array[candidate->dest].head;
-            partialOutput[it++] = candidate;
+int maskedArgmin(const int *row, const int *mask, int n)
+{
+    int best = -1;
+    int bestValue = INT_MAX;
+    int j = 0;
+#if defined(__AVX512F__)
+    __m512i vmin = _mm512_set1_epi32(INT_MAX);
+    __m512i vidx = _mm512_set1_epi32(-1);
+    __m512i idx = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i step = _mm512_set1_epi32(16);
+    for (; j + 16 <= n; j += 16)
+    {
+        __m512i v = _mm512_or_si512(_mm512_loadu_si512(row + j), _mm512_loadu_si512(mask + j));
+        __mmask16 lt = _mm512_cmpgt_epi32_mask(vmin, v);
+        vmin = _mm512_mask_mov_epi32(vmin, lt, v);
+        vidx = _mm512_mask_mov_epi32(vidx, lt, idx);
+        idx = _mm512_add_epi32(idx, step);
+    }
+    int values[16], indices[16];
+    _mm512_storeu_si512(values, vmin);
+    _mm512_storeu_si512(indices, vidx);
+    for (int k = 0; k < 16; ++k)
+    {
+        if (values[k] < bestValue || (values[k] == bestValue && values[k] != INT_MAX && indices[k] < best))
+        {
+            bestValue = values[k];
+            best = indices[k];
         }
-        bool found = false;
-        while (looped && el)
+    }
+#elif defined(__AVX2__)
+    __m256i vmin = _mm256_set1_epi32(INT_MAX);
+    __m256i vidx = _mm256_set1_epi32(-1);
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+    for (; j + 8 <= n; j += 8)
+    {
+        __m256i v = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(row + j)), _mm256_loadu_si256((const __m256i *)(mask + j)));
+        __m256i lt = _mm256_cmpgt_epi32(vmin, v);
+        vmin = _mm256_blendv_epi8(vmin, v, lt);
+        vidx = _mm256_blendv_epi8(vidx, idx, lt);
+        idx = _mm256_add_epi32(idx, step);
+    }
+    int values[8], indices[8];
+    _mm256_storeu_si256((__m256i *)values, vmin);
+    _mm256_storeu_si256((__m256i *)indices, vidx);
+    for (int k = 0; k < 8; ++k)
+    {
+        if (values[k] < bestValue || (values[k] == bestValue && values[k] != INT_MAX && indices[k] < best))
+        {
+            bestValue = values[k];
+            best = indices[k];
+        }
+    }
+#endif
+    for (; j < n; ++j)
+    {
+        int value = row[j] | mask[j];
+        if (value < bestValue)
+        {
+            bestValue = value;
+            best = j;
+        }
+    }
+    return bestValue == INT_MAX ? -1 : best;
+}
+
+int greedyTourDense(const int *matrix, int n, int start, int *mask, int *order)
+{
+    fill_n(mask, n, 0);
+    mask[start] = INT_MAX;
+    order[0] = start;
+    int sum = 0;
+    int current = start;
+    for (int j = 1; j < n; ++j)
+    {
+        int next = maskedArgmin(matrix + (size_t)current * n, mask, n);
+        if (next < 0)
+            return INT_MAX;
+
+        sum += matrix[(size_t)current * n + next];
+        mask[next] = INT_MAX;
+        order[j] = next;
+        current = next;
+    }
+    int back = matrix[(size_t)current * n + start];
+    return back == INT_MAX ? INT_MAX : sum + back;
+}
+
+void denseWorker(const int *matrix, int n, atomic<int> *next, int *output, int *minSum, int *minStart)
+{
+    int *mask = (int *)malloc(n * sizeof(int));
+    int *order = (int *)malloc(n * sizeof(int));
+    for (int i = next->fetch_add(1); i < n; i = next->fetch_add(1))
+    {
+        int sum = greedyTourDense(matrix, n, i, mask, order);
+        if (sum < *minSum || (sum == *minSum && sum != INT_MAX && i < *minStart))
+        {
+            memcpy(output, order, n * sizeof(int));
+            *minSum = sum;
+            *minStart = i;
+        }
+    }
+    free(mask);
+    free(order);
+}
+
+Result nearestNeighborDense(const int *matrix, int n, int threads = 0)
+{
+    if (threads <= 0)
+        threads = (int)thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    int *orders = (int *)malloc((size_t)threads * n * sizeof(int));
+    vector<int> sums(threads, INT_MAX);
+    vector<int> starts(threads, INT_MAX);
+    atomic<int> next(0);
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back(denseWorker, matrix, n, &next, orders + (size_t)t * n, &sums[t], &starts[t]);
+    for (auto &w : workers)
+        w.join();
+
+    int best = 0;
+    for (int t = 1; t < threads; ++t)
+        if (sums[t] < sums[best] || (sums[t] == sums[best] && starts[t] < starts[best]))
+            best = t;
+
+    Result r;
+    r.nodes = (ListNode **)calloc(n, sizeof(ListNode *));
+    r.distance = sums[best];
+    if (r.distance != INT_MAX)
+    {
+        const int *order = orders + (size_t)best * n;
+        for (int i = 0; i < n; ++i)
+        {
+            int a = order[i];
+            int b = order[(i + 1) % n];
+            r.nodes[i] = makeListNode(a, b, matrix[(size_t)a * n + b]);
+        }
+    }
+    free(orders);
+    return r;
+}
+
+struct City
+{
+    double x;
+    double y;
+};
+
+struct KdTree
+{
+    int n;
+    const City *cities;
+    int *order;
+    int *position;
+    int *parent;
+    int *count;
+    char *axis;
+    bool *alive;
+};
+
+int buildKdRange(KdTree *t, int lo, int hi, int up)
+{
+    if (lo >= hi)
+        return 0;
+
+    double minX = t->cities[t->order[lo]].x, maxX = minX;
+    double minY = t->cities[t->order[lo]].y, maxY = minY;
+    for (int i = lo + 1; i < hi; ++i)
+    {
+        const City &c = t->cities[t->order[i]];
+        minX = min(minX, c.x);
+        maxX = max(maxX, c.x);
+        minY = min(minY, c.y);
+        maxY = max(maxY, c.y);
+    }
+    char axis = maxX - minX >= maxY - minY ? 0 : 1;
+
+    int mid = lo + (hi - lo) / 2;
+    const City *cities = t->cities;
+    nth_element(t->order + lo, t->order + mid, t->order + hi, [cities, axis](int a, int b)
+    {
+        return axis == 0 ? cities[a].x < cities[b].x : cities[a].y < cities[b].y;
+    });
+
+    t->axis[mid] = axis;
+    t->parent[mid] = up;
+    t->alive[mid] = true;
+    t->position[t->order[mid]] = mid;
+    t->count[mid] = 1 + buildKdRange(t, lo, mid, mid) + buildKdRange(t, mid + 1, hi, mid);
+    return t->count[mid];
+}
+
+KdTree* makeKdTree(const City *cities, int n)
+{
+    KdTree *t = (KdTree *)malloc(sizeof(KdTree));
+    t->n = n;
+    t->cities = cities;
+    t->order = (int *)malloc(n * sizeof(int));
+    t->position = (int *)malloc(n * sizeof(int));
+    t->parent = (int *)malloc(n * sizeof(int));
+    t->count = (int *)malloc(n * sizeof(int));
+    t->axis = (char *)malloc(n * sizeof(char));
+    t->alive = (bool *)malloc(n * sizeof(bool));
+    for (int i = 0; i < n; ++i)
+        t->order[i] = i;
+    buildKdRange(t, 0, n, -1);
+    return t;
+}
+
+void freeKdTree(KdTree *t)
+{
+    free(t->order);
+    free(t->position);
+    free(t->parent);
+    free(t->count);
+    free(t->axis);
+    free(t->alive);
+    free(t);
+}
+
+void removeKd(KdTree *t, int city)
+{
+    int node = t->position[city];
+    if (!t->alive[node])
+        return;
+
+    t->alive[node] = false;
+    for (; node != -1; node = t->parent[node])
+        t->count[node]--;
+}
+
+void nearestKd(const KdTree *t, int lo, int hi, double x, double y, int *best, double *bestDist)
+{
+    if (lo >= hi)
+        return;
+    int mid = lo + (hi - lo) / 2;
+    if (t->count[mid] == 0)
+        return;
+
+    const City &c = t->cities[t->order[mid]];
+    if (t->alive[mid])
+    {
+        double d = (c.x - x) * (c.x - x) + (c.y - y) * (c.y - y);
+        if (d < *bestDist)
+        {
+            *bestDist = d;
+            *best = t->order[mid];
+        }
+    }
+
+    double diff = t->axis[mid] == 0 ? x - c.x : y - c.y;
+    if (diff < 0)
+    {
+        nearestKd(t, lo, mid, x, y, best, bestDist);
+        if (diff * diff < *bestDist)
+            nearestKd(t, mid + 1, hi, x, y, best, bestDist);
+    }
+    else
+    {
+        nearestKd(t, mid + 1, hi, x, y, best, bestDist);
+        if (diff * diff < *bestDist)
+            nearestKd(t, lo, mid, x, y, best, bestDist);
+    }
+}
+
+int cityDistance(const City &a, const City &b)
+{
+    return (int)(sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y)) + 0.5);
+}
+
+Result nearestNeighborEuclidean(const City *cities, int n, int start = 0)
+{
+    Result r;
+    r.nodes = NULL;
+    r.distance = 0;
+    if (n <= 0)
+        return r;
+    if (start < 0 || start >= n)
+    {
+        r.distance = INT_MAX;
+        return r;
+    }
+
+    KdTree *t = makeKdTree(cities, n);
+    r.nodes = (ListNode **)calloc(n, sizeof(ListNode *));
+
+    int current = start;
+    removeKd(t, current);
+    for (int j = 0; j < n - 1; ++j)
+    {
+        int next = -1;
+        double bestDist = INFINITY;
+        nearestKd(t, 0, n, cities[current].x, cities[current].y, &next, &bestDist);
+        removeKd(t, next);
+
+        int weight = cityDistance(cities[current], cities[next]);
+        r.nodes[j] = makeListNode(current, next, weight);
+        r.distance += weight;
+        current = next;
+    }
+    int weight = cityDistance(cities[current], cities[start]);
+    r.nodes[n - 1] = makeListNode(current, start, weight);
+    r.distance += weight;
+
+    freeKdTree(t);
+    return r;
+}
+
+unsigned int hilbertIndex(unsigned int x, unsigned int y)
+{
+    unsigned int d = 0;
+    for (unsigned int s = 1u << 15; s > 0; s >>= 1)
+    {
+        unsigned int rx = (x & s) > 0;
+        unsigned int ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if (ry == 0)
         {
-            if (el->dest == i)
+            if (rx == 1)
             {
-                found = true;
-                sum += el->weight;
-                partialOutput[it++] = el;
+                x = s - 1 - x;
+                y = s - 1 - y;
             }
-            el = el->next;
+            unsigned int tmp = x;
+            x = y;
+            y = tmp;
         }
-        if (looped && found && sum < minSum)
+    }
+    return d;
+}
+
+void radixPass(const unsigned int *keys, const int *values, unsigned int *outKeys, int *outValues, int n, int shift, int threads)
+{
+    vector<int> counts((size_t)threads * 256, 0);
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]()
         {
-            memcpy(output, partialOutput, g->vertices * sizeof(ListNode *));
-            minSum = sum;
+            int *count = &counts[(size_t)t * 256];
+            for (int i = (int)((long long)n * t / threads); i < (int)((long long)n * (t + 1) / threads); ++i)
+                count[(keys[i] >> shift) & 255]++;
+        });
+    for (auto &w : workers)
+        w.join();
+    workers.clear();
+
+    int offset = 0;
+    for (int digit = 0; digit < 256; ++digit)
+        for (int t = 0; t < threads; ++t)
+        {
+            int c = counts[(size_t)t * 256 + digit];
+            counts[(size_t)t * 256 + digit] = offset;
+            offset += c;
         }
 
-        fill_n(visited, g->vertices, false);
-        fill_n(partialOutput, g->vertices, nullptr);
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]()
+        {
+            int *next = &counts[(size_t)t * 256];
+            for (int i = (int)((long long)n * t / threads); i < (int)((long long)n * (t + 1) / threads); ++i)
+            {
+                int slot = next[(keys[i] >> shift) & 255]++;
+                outKeys[slot] = keys[i];
+                outValues[slot] = values[i];
+            }
+        });
+    for (auto &w : workers)
+        w.join();
+}
+
+void parallelRadixSort(unsigned int *keys, int *values, int n, int threads)
+{
+    unsigned int *tmpKeys = (unsigned int *)malloc(n * sizeof(unsigned int));
+    int *tmpValues = (int *)malloc(n * sizeof(int));
+    for (int shift = 0; shift < 32; shift += 16)
+    {
+        radixPass(keys, values, tmpKeys, tmpValues, n, shift, threads);
+        radixPass(tmpKeys, tmpValues, keys, values, n, shift + 8, threads);
     }
-    free(partialOutput);
-    free(visited);
-    r.nodes = output;
-    r.distance = minSum;
+    free(tmpKeys);
+    free(tmpValues);
+}
+
+Result hilbertTour(const City *cities, int n, int threads = 0)
+{
+    if (n <= 0)
+    {
+        Result r;
+        r.nodes = NULL;
+        r.distance = 0;
+        return r;
+    }
+
+    if (threads <= 0)
+        threads = (int)thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    double minX = cities[0].x, maxX = minX, minY = cities[0].y, maxY = minY;
+    for (int i = 1; i < n; ++i)
+    {
+        minX = min(minX, cities[i].x);
+        maxX = max(maxX, cities[i].x);
+        minY = min(minY, cities[i].y);
+        maxY = max(maxY, cities[i].y);
+    }
+    double scale = 65535.0 / max(max(maxX - minX, maxY - minY), 1e-12);
+
+    unsigned int *keys = (unsigned int *)malloc(n * sizeof(unsigned int));
+    int *order = (int *)malloc(n * sizeof(int));
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]()
+        {
+            for (int i = (int)((long long)n * t / threads); i < (int)((long long)n * (t + 1) / threads); ++i)
+            {
+                keys[i] = hilbertIndex((unsigned int)((cities[i].x - minX) * scale), (unsigned int)((cities[i].y - minY) * scale));
+                order[i] = i;
+            }
+        });
+    for (auto &w : workers)
+        w.join();
+
+    parallelRadixSort(keys, order, n, threads);
+
+    Result r;
+    r.nodes = (ListNode **)calloc(n, sizeof(ListNode *));
+    r.distance = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        int a = order[i];
+        int b = order[(i + 1) % n];
+        int weight = cityDistance(cities[a], cities[b]);
+        r.nodes[i] = makeListNode(a, b, weight);
+        r.distance += weight;
+    }
+
+    free(keys);
+    free(order);
     return r;
 }
 
-void printSolution(int vertices, Result res)
+void kNearestKd(const KdTree *t, int lo, int hi, double x, double y, int k, int self, int *idx, double *dist, int *found)
 {
-    for (int i = 0; i < vertices; ++i)
+    if (lo >= hi)
+        return;
+    int mid = lo + (hi - lo) / 2;
+    const City &c = t->cities[t->order[mid]];
+    if (t->order[mid] != self)
     {
-        cout << res.nodes[i]->src << " -> " << res.nodes[i]->dest << " : " << res.nodes[i]->weight << endl;
+        double d = (c.x - x) * (c.x - x) + (c.y - y) * (c.y - y);
+        if (*found < k || d < dist[*found - 1])
+        {
+            int i = *found < k ? (*found)++ : k - 1;
+            while (i > 0 && dist[i - 1] > d)
+            {
+                dist[i] = dist[i - 1];
+                idx[i] = idx[i - 1];
+                i--;
+            }
+            dist[i] = d;
+            idx[i] = t->order[mid];
+        }
     }
-    cout << "Distance: " << res.distance << endl;
+
+    double diff = t->axis[mid] == 0 ? x - c.x : y - c.y;
+    int nearLo = diff < 0 ? lo : mid + 1;
+    int nearHi = diff < 0 ? mid : hi;
+    int farLo = diff < 0 ? mid + 1 : lo;
+    int farHi = diff < 0 ? hi : mid;
+    kNearestKd(t, nearLo, nearHi, x, y, k, self, idx, dist, found);
+    if (*found < k || diff * diff < dist[*found - 1])
+        kNearestKd(t, farLo, farHi, x, y, k, self, idx, dist, found);
 }
 
-int main()
+struct TourMetric
 {
-    int V = 7;
-    int directed = false;
-    Graph* graph = makeGraph(V, directed);
+    int n;
+    const int *matrix;
+    const City *cities;
+};
 
-    addEdge(graph, 0, 1, 10);
-    addEdge(graph, 0, 3, 4);
-    addEdge(graph, 0, 4, 1);
-    addEdge(graph, 1, 2, 1);
-    addEdge(graph, 1, 4, 3);
-    addEdge(graph, 1, 5, 15);
-    addEdge(graph, 2, 3, 1);
-    addEdge(graph, 2, 4, 2);
-    addEdge(graph, 3, 4, 3);
-    addEdge(graph, 3, 5, 7);
-    addEdge(graph, 3, 6, 5);
-    addEdge(graph, 5, 6, 6);
+inline int metricDistance(const TourMetric *m, int a, int b)
+{
+    return m->matrix ? m->matrix[(size_t)a * m->n + b] : cityDistance(m->cities[a], m->cities[b]);
+}
 
-    // addEdge(graph, 0, 1, 5);
-    // // addEdge(graph, 0, 2, 26);
-    // addEdge(graph, 0, 3, 4);
-    // addEdge(graph, 0, 4, 2);
-    // addEdge(graph, 1, 2, 7);
-    // // addEdge(graph, 1, 3, 21);
-    // addEdge(graph, 1, 4, 3);
-    // addEdge(graph, 2, 3, 6);
-    // addEdge(graph, 2, 4, 2);
-    // addEdge(graph, 3, 4, 1);
-    
-    Result res = nearestNeighbor(graph);
-    
-    printSolution(graph->vertices, res);
+int* candidateLists(const TourMetric *m, int k)
+{
+    int n = m->n;
+    int *cand = (int *)malloc((size_t)n * k * sizeof(int));
+    if (m->matrix)
+    {
+        vector<int> order(n);
+        for (int a = 0; a < n; ++a)
+        {
+            int count = 0;
+            for (int b = 0; b < n; ++b)
+                if (b != a)
+                    order[count++] = b;
+            const int *row = m->matrix + (size_t)a * n;
+            partial_sort(order.begin(), order.begin() + k, order.begin() + count, [row](int x, int y) { return row[x] < row[y]; });
+            memcpy(cand + (size_t)a * k, order.data(), k * sizeof(int));
+        }
+    }
+    else
+    {
+        KdTree *t = makeKdTree(m->cities, n);
+        vector<double> dist(k);
+        for (int a = 0; a < n; ++a)
+        {
+            int found = 0;
+            kNearestKd(t, 0, n, m->cities[a].x, m->cities[a].y, k, a, cand + (size_t)a * k, dist.data(), &found);
+        }
+        freeKdTree(t);
+    }
+    return cand;
+}
+
+struct ArrayTour
+{
+    int n;
+    int *order;
+    int *position;
+};
+
+inline int tourNext(const ArrayTour *t, int a)
+{
+    int i = t->position[a] + 1;
+    return t->order[i == t->n ? 0 : i];
+}
+
+inline int tourPrev(const ArrayTour *t, int a)
+{
+    int i = t->position[a];
+    return t->order[i == 0 ? t->n - 1 : i - 1];
+}
+
+inline bool tourBetween(const ArrayTour *t, int a, int b, int c)
+{
+    int i = t->position[a], j = t->position[b], k = t->position[c];
+    return i <= k ? i <= j && j <= k : i <= j || j <= k;
+}
+
+void tourFlip(ArrayTour *t, int a, int b)
+{
+    int n = t->n;
+    int i = t->position[a];
+    int j = t->position[b];
+    int length = (j - i + n) % n + 1;
+    if (length * 2 > n)
+    {
+        int tmp = (j + 1) % n;
+        j = (i - 1 + n) % n;
+        i = tmp;
+        length = n - length;
+    }
+    for (int s = 0; s < length / 2; ++s)
+    {
+        int x = t->order[i];
+        int y = t->order[j];
+        t->order[i] = y;
+        t->position[y] = i;
+        t->order[j] = x;
+        t->position[x] = j;
+        i = i + 1 == n ? 0 : i + 1;
+        j = j == 0 ? n - 1 : j - 1;
+    }
+}
+
+struct TwoLevelTour
+{
+    int n;
+    int groupSize;
+    int *segment;
+    int *index;
+    vector<vector<int>> cities;
+    vector<char> reversed;
+    vector<int> segNext;
+    vector<int> segPrev;
+    vector<int> rank;
+};
+
+inline int segmentAt(const TwoLevelTour *t, int s, int k)
+{
+    const vector<int> &c = t->cities[s];
+    return c[t->reversed[s] ? c.size() - 1 - k : k];
+}
+
+inline int traversalIndex(const TwoLevelTour *t, int v)
+{
+    int s = t->segment[v];
+    return t->reversed[s] ? (int)t->cities[s].size() - 1 - t->index[v] : t->index[v];
+}
+
+inline int tourNext(const TwoLevelTour *t, int a)
+{
+    int s = t->segment[a];
+    int k = traversalIndex(t, a) + 1;
+    if (k < (int)t->cities[s].size())
+        return segmentAt(t, s, k);
+    return segmentAt(t, t->segNext[s], 0);
+}
+
+inline int tourPrev(const TwoLevelTour *t, int a)
+{
+    int s = t->segment[a];
+    int k = traversalIndex(t, a) - 1;
+    if (k >= 0)
+        return segmentAt(t, s, k);
+    int p = t->segPrev[s];
+    return segmentAt(t, p, (int)t->cities[p].size() - 1);
+}
+
+inline bool tourBetween(const TwoLevelTour *t, int a, int b, int c)
+{
+    long long ka = (long long)t->rank[t->segment[a]] * t->n + traversalIndex(t, a);
+    long long kb = (long long)t->rank[t->segment[b]] * t->n + traversalIndex(t, b);
+    long long kc = (long long)t->rank[t->segment[c]] * t->n + traversalIndex(t, c);
+    return ka <= kc ? ka <= kb && kb <= kc : ka <= kb || kb <= kc;
+}
+
+void reindexSegment(TwoLevelTour *t, int s)
+{
+    vector<int> &c = t->cities[s];
+    for (int i = 0; i < (int)c.size(); ++i)
+    {
+        t->segment[c[i]] = s;
+        t->index[c[i]] = i;
+    }
+}
+
+void renumberSegments(TwoLevelTour *t)
+{
+    int s = 0;
+    for (int r = 0; r < (int)t->rank.size(); ++r)
+    {
+        t->rank[s] = r;
+        s = t->segNext[s];
+    }
+}
+
+vector<int> takeCities(TwoLevelTour *t, int s, int from, int to)
+{
+    vector<int> &c = t->cities[s];
+    int size = (int)c.size();
+    int lo = t->reversed[s] ? size - to : from;
+    int hi = t->reversed[s] ? size - from : to;
+    vector<int> part(c.begin() + lo, c.begin() + hi);
+    if (t->reversed[s])
+        reverse(part.begin(), part.end());
+    c.erase(c.begin() + lo, c.begin() + hi);
+    reindexSegment(t, s);
+    return part;
+}
+
+void splitOversized(TwoLevelTour *t, int s)
+{
+    if ((int)t->cities[s].size() <= 2 * t->groupSize)
+        return;
+
+    int half = (int)t->cities[s].size() / 2;
+    int q = (int)t->cities.size();
+    t->cities.push_back(takeCities(t, s, half, (int)t->cities[s].size()));
+    t->reversed.push_back(0);
+    t->rank.push_back(0);
+    t->segNext.push_back(t->segNext[s]);
+    t->segPrev.push_back(s);
+    t->segPrev[t->segNext[s]] = q;
+    t->segNext[s] = q;
+    reindexSegment(t, q);
+    renumberSegments(t);
+}
+
+void appendCities(TwoLevelTour *t, int p, const vector<int> &part)
+{
+    vector<int> &c = t->cities[p];
+    if (t->reversed[p])
+        c.insert(c.begin(), part.rbegin(), part.rend());
+    else
+        c.insert(c.end(), part.begin(), part.end());
+    reindexSegment(t, p);
+    splitOversized(t, p);
+}
+
+void prependCities(TwoLevelTour *t, int q, const vector<int> &part)
+{
+    vector<int> &c = t->cities[q];
+    if (t->reversed[q])
+        c.insert(c.end(), part.rbegin(), part.rend());
+    else
+        c.insert(c.begin(), part.begin(), part.end());
+    reindexSegment(t, q);
+    splitOversized(t, q);
+}
+
+void splitBefore(TwoLevelTour *t, int v)
+{
+    int s = t->segment[v];
+    int k = traversalIndex(t, v);
+    int size = (int)t->cities[s].size();
+    if (k == 0)
+        return;
+
+    if (k <= size - k)
+        appendCities(t, t->segPrev[s], takeCities(t, s, 0, k));
+    else
+        prependCities(t, t->segNext[s], takeCities(t, s, k, size));
+}
+
+void reverseInside(TwoLevelTour *t, int a, int b)
+{
+    int s = t->segment[a];
+    int lo = min(t->index[a], t->index[b]);
+    int hi = max(t->index[a], t->index[b]);
+    vector<int> &c = t->cities[s];
+    reverse(c.begin() + lo, c.begin() + hi + 1);
+    for (int i = lo; i <= hi; ++i)
+        t->index[c[i]] = i;
+}
+
+void tourFlip(TwoLevelTour *t, int a, int b)
+{
+    if (a == b || tourNext(t, b) == a)
+        return;
+
+    int segments = (int)t->cities.size();
+    int span = (t->rank[t->segment[b]] - t->rank[t->segment[a]] + segments) % segments;
+    if (t->segment[a] == t->segment[b] && traversalIndex(t, a) > traversalIndex(t, b))
+        span = segments;
+    if (span * 2 > segments)
+    {
+        int na = tourNext(t, b);
+        b = tourPrev(t, a);
+        a = na;
+    }
+
+    for (;;)
+    {
+        if (t->segment[a] == t->segment[b] && traversalIndex(t, a) <= traversalIndex(t, b))
+        {
+            reverseInside(t, a, b);
+            return;
+        }
+        if (traversalIndex(t, a) != 0)
+        {
+            splitBefore(t, a);
+            continue;
+        }
+        int after = tourNext(t, b);
+        if (t->segment[after] == t->segment[b])
+        {
+            splitBefore(t, after);
+            continue;
+        }
+        break;
+    }
+
+    segments = (int)t->cities.size();
+    int first = t->segment[a];
+    int last = t->segment[b];
+    int before = t->segPrev[first];
+    int after = t->segNext[last];
+    int startRank = t->rank[first];
+
+    vector<int> run;
+    for (int s = first;; s = t->segNext[s])
+    {
+        run.push_back(s);
+        if (s == last)
+            break;
+    }
+
+    for (int i = 0; i < (int)run.size(); ++i)
+    {
+        int s = run[i];
+        t->reversed[s] ^= 1;
+        swap(t->segNext[s], t->segPrev[s]);
+        t->rank[s] = (startRank + (int)run.size() - 1 - i) % segments;
+    }
+    t->segNext[before] = last;
+    t->segPrev[last] = before;
+    t->segPrev[after] = first;
+    t->segNext[first] = after;
+}
+
+TwoLevelTour* makeTwoLevelTour(const int *order, int n)
+{
+    TwoLevelTour *t = new TwoLevelTour();
+    t->n = n;
+    t->groupSize = max(8, (int)sqrt((double)n));
+    t->segment = (int *)malloc(n * sizeof(int));
+    t->index = (int *)malloc(n * sizeof(int));
+
+    int segments = (n + t->groupSize - 1) / t->groupSize;
+    t->cities.resize(segments);
+    t->reversed.assign(segments, 0);
+    t->segNext.resize(segments);
+    t->segPrev.resize(segments);
+    t->rank.resize(segments);
+    for (int s = 0; s < segments; ++s)
+    {
+        t->cities[s].assign(order + (size_t)s * n / segments, order + (size_t)(s + 1) * n / segments);
+        t->segNext[s] = (s + 1) % segments;
+        t->segPrev[s] = (s + segments - 1) % segments;
+        t->rank[s] = s;
+        reindexSegment(t, s);
+    }
+    return t;
+}
+
+void freeTwoLevelTour(TwoLevelTour *t)
+{
+    free(t->segment);
+    free(t->index);
+    delete t;
+}
+
+template <typename Tour>
+void twoOptMove(Tour *t, int a, int b, int c, int d)
+{
+    if (tourNext(t, a) == b)
+        tourFlip(t, b, c);
+    else
+        tourFlip(t, a, d);
+}
+
+struct ActiveQueue
+{
+    vector<int> items;
+    vector<bool> queued;
+    size_t head = 0;
+    size_t count = 0;
+
+    void push(int a)
+    {
+        if (queued[a])
+            return;
+        queued[a] = true;
+        items[(head + count++) % items.size()] = a;
+    }
+
+    int pop()
+    {
+        int a = items[head];
+        head = (head + 1) % items.size();
+        count--;
+        queued[a] = false;
+        return a;
+    }
+};
+
+template <typename Tour>
+bool tryTwoOpt(Tour *t, const TourMetric *m, const int *cand, int k, int a, ActiveQueue &active)
+{
+    for (int dir = 0; dir < 2; ++dir)
+    {
+        int b = dir == 0 ? tourNext(t, a) : tourPrev(t, a);
+        int dab = metricDistance(m, a, b);
+        for (int i = 0; i < k; ++i)
+        {
+            int c = cand[(size_t)a * k + i];
+            int dac = metricDistance(m, a, c);
+            if (dac >= dab)
+                break;
+            int d = dir == 0 ? tourNext(t, c) : tourPrev(t, c);
+            if (c == b || d == a)
+                continue;
+
+            if (dac + metricDistance(m, b, d) < dab + metricDistance(m, c, d))
+            {
+                twoOptMove(t, a, b, c, d);
+                active.push(a);
+                active.push(b);
+                active.push(c);
+                active.push(d);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <typename Tour>
+bool tryOrOpt(Tour *t, const TourMetric *m, const int *cand, int k, int a, ActiveQueue &active)
+{
+    int s = a;
+    for (int length = 1; length <= 3 && length + 3 <= m->n; ++length)
+    {
+        if (length > 1)
+            s = tourNext(t, s);
+        int p = tourPrev(t, a);
+        int nx = tourNext(t, s);
+        int removeGain = metricDistance(m, p, a) + metricDistance(m, s, nx) - metricDistance(m, p, nx);
+        if (removeGain <= 0)
+            continue;
+
+        for (int side = 0; side < 2; ++side)
+        {
+            int end = side == 0 ? a : s;
+            for (int i = 0; i < k; ++i)
+            {
+                int c = cand[(size_t)end * k + i];
+                if (metricDistance(m, end, c) >= removeGain)
+                    break;
+                if (tourBetween(t, a, c, s))
+                    continue;
+
+                for (int dir = 0; dir < 2; ++dir)
+                {
+                    int e = dir == 0 ? tourNext(t, c) : tourPrev(t, c);
+                    if (tourBetween(t, a, e, s))
+                        continue;
+                    int u = dir == 0 ? c : e;
+                    int w = dir == 0 ? e : c;
+                    if (u == nx || w == p)
+                        continue;
+
+                    int duw = metricDistance(m, u, w);
+                    int reversed = metricDistance(m, u, s) + metricDistance(m, a, w) - duw;
+                    int forward = metricDistance(m, u, a) + metricDistance(m, s, w) - duw;
+                    if (min(reversed, forward) >= removeGain)
+                        continue;
+
+                    twoOptMove(t, p, a, u, w);
+                    twoOptMove(t, p, u, nx, s);
+                    if (forward < reversed)
+                        twoOptMove(t, u, s, a, w);
+
+                    active.push(p);
+                    active.push(nx);
+                    active.push(a);
+                    active.push(s);
+                    active.push(u);
+                    active.push(w);
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+template <typename Tour>
+void localSearch(Tour *t, const TourMetric *m, const int *cand, int k, int first, const int *seeds = NULL, int seedCount = 0)
+{
+    ActiveQueue active;
+    active.items.resize(m->n);
+    active.queued.assign(m->n, false);
+    int a = first;
+    for (int i = 0; i < seedCount; ++i)
+        active.push(seeds[i]);
+    for (int i = 0; seeds == NULL && i < m->n; ++i)
+    {
+        active.push(a);
+        a = tourNext(t, a);
+    }
+
+    while (active.count > 0)
+    {
+        a = active.pop();
+        while (tryTwoOpt(t, m, cand, k, a, active) || tryOrOpt(t, m, cand, k, a, active))
+        {
+        }
+    }
+}
+
+template <typename Tour>
+Result tourResult(const Tour *t, const TourMetric *m, int first)
+{
+    Result out;
+    out.nodes = (ListNode **)calloc(m->n, sizeof(ListNode *));
+    out.distance = 0;
+    int a = first;
+    for (int i = 0; i < m->n; ++i)
+    {
+        int b = tourNext(t, a);
+        int weight = metricDistance(m, a, b);
+        out.nodes[i] = makeListNode(a, b, weight);
+        out.distance += weight;
+        a = b;
+    }
+    return out;
+}
+
+const int TWO_LEVEL_THRESHOLD = 20000;
+
+Result improveOrder(const TourMetric *m, int *order, const int *cand, int k, const int *seeds = NULL, int seedCount = 0)
+{
+    int n = m->n;
+    Result out;
+    if (n >= TWO_LEVEL_THRESHOLD)
+    {
+        TwoLevelTour *t = makeTwoLevelTour(order, n);
+        localSearch(t, m, cand, k, order[0], seeds, seedCount);
+        out = tourResult(t, m, order[0]);
+        freeTwoLevelTour(t);
+    }
+    else
+    {
+        ArrayTour t;
+        t.n = n;
+        t.order = order;
+        t.position = (int *)malloc(n * sizeof(int));
+        for (int i = 0; i < n; ++i)
+            t.position[order[i]] = i;
+        localSearch(&t, m, cand, k, order[0], seeds, seedCount);
+        out = tourResult(&t, m, order[0]);
+        free(t.position);
+    }
+    return out;
+}
+
+Result improveTour(const TourMetric *m, Result r, int k)
+{
+    int n = m->n;
+    if (k > n - 1)
+        k = n - 1;
+
+    int *order = (int *)malloc(n * sizeof(int));
+    for (int i = 0; i < n; ++i)
+        order[i] = r.nodes[i]->src;
+    int *cand = candidateLists(m, k);
+
+    Result out = improveOrder(m, order, cand, k);
+
+    free(cand);
+    free(order);
+    return out;
+}
+
+Result improveTour(const int *matrix, int n, Result r, int k = 10)
+{
+    TourMetric m = { n, matrix, NULL };
+    return improveTour(&m, r, k);
+}
+
+Result improveTour(const City *cities, int n, Result r, int k = 10)
+{
+    TourMetric m = { n, NULL, cities };
+    return improveTour(&m, r, k);
+}
+
+void freeResult(Result r, int n)
+{
+    for (int i = 0; i < n; ++i)
+        free(r.nodes[i]);
+    free(r.nodes);
+}
+
+void karpCells(const City *cities, int *ids, int lo, int hi, int cellSize, vector<pair<int, int>> &cells)
+{
+    if (hi - lo <= cellSize)
+    {
+        cells.push_back({ lo, hi });
+        return;
+    }
+
+    double minX = cities[ids[lo]].x, maxX = minX, minY = cities[ids[lo]].y, maxY = minY;
+    for (int i = lo + 1; i < hi; ++i)
+    {
+        minX = min(minX, cities[ids[i]].x);
+        maxX = max(maxX, cities[ids[i]].x);
+        minY = min(minY, cities[ids[i]].y);
+        maxY = max(maxY, cities[ids[i]].y);
+    }
+    bool byX = maxX - minX >= maxY - minY;
+    int mid = lo + (hi - lo) / 2;
+    nth_element(ids + lo, ids + mid, ids + hi, [cities, byX](int a, int b)
+    {
+        return byX ? cities[a].x < cities[b].x : cities[a].y < cities[b].y;
+    });
+    karpCells(cities, ids, lo, mid, cellSize, cells);
+    karpCells(cities, ids, mid, hi, cellSize, cells);
+}
+
+void solveCell(const City *cities, const int *ids, int lo, int hi, vector<int> &tour)
+{
+    int m = hi - lo;
+    tour.assign(ids + lo, ids + hi);
+    if (m <= 3)
+        return;
+
+    vector<City> local(m);
+    for (int i = 0; i < m; ++i)
+        local[i] = cities[ids[lo + i]];
+
+    Result greedy = nearestNeighborEuclidean(local.data(), m);
+    Result improved = improveTour(local.data(), m, greedy, min(10, m - 1));
+    for (int i = 0; i < m; ++i)
+        tour[i] = ids[lo + improved.nodes[i]->src];
+    freeResult(greedy, m);
+    freeResult(improved, m);
+}
+
+Result karpTour(const City *cities, int n, int cellSize = 2000, int threads = 0)
+{
+    if (threads <= 0)
+        threads = (int)thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+    if (cellSize < 4)
+        cellSize = 4;
+
+    int *ids = (int *)malloc(n * sizeof(int));
+    for (int i = 0; i < n; ++i)
+        ids[i] = i;
+    vector<pair<int, int>> cells;
+    karpCells(cities, ids, 0, n, cellSize, cells);
+
+    int count = (int)cells.size();
+    vector<City> centroid(count);
+    vector<int> cellOf(n);
+    for (int c = 0; c < count; ++c)
+    {
+        centroid[c] = { 0, 0 };
+        for (int i = cells[c].first; i < cells[c].second; ++i)
+        {
+            centroid[c].x += cities[ids[i]].x;
+            centroid[c].y += cities[ids[i]].y;
+            cellOf[ids[i]] = c;
+        }
+        int m = cells[c].second - cells[c].first;
+        centroid[c].x /= m;
+        centroid[c].y /= m;
+    }
+
+    Result curve = hilbertTour(centroid.data(), count, threads);
+    vector<int> cellOrder(count);
+    for (int c = 0; c < count; ++c)
+        cellOrder[c] = curve.nodes[c]->src;
+    freeResult(curve, count);
+
+    vector<vector<int>> tours(count);
+    atomic<int> next(0);
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&]()
+        {
+            for (int c = next.fetch_add(1); c < count; c = next.fetch_add(1))
+                solveCell(cities, ids, cells[c].first, cells[c].second, tours[c]);
+        });
+    for (auto &w : workers)
+        w.join();
+
+    int *order = (int *)malloc(n * sizeof(int));
+    vector<int> seeds;
+    int length = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const vector<int> &sub = tours[cellOrder[i]];
+        int m = (int)sub.size();
+        int entry = 0;
+        if (length > 0)
+        {
+            int exit = order[length - 1];
+            for (int j = 1; j < m; ++j)
+                if (cityDistance(cities[exit], cities[sub[j]]) < cityDistance(cities[exit], cities[sub[entry]]))
+                    entry = j;
+        }
+
+        const City &target = i + 1 < count ? centroid[cellOrder[i + 1]] : cities[length > 0 ? order[0] : sub[entry]];
+        int forwardExit = sub[(entry + m - 1) % m];
+        int backwardExit = sub[(entry + 1) % m];
+        int step = cityDistance(cities[forwardExit], target) <= cityDistance(cities[backwardExit], target) ? 1 : m - 1;
+        for (int j = 0, k = entry; j < m; ++j, k = (k + step) % m)
+            order[length++] = sub[k];
+
+        seeds.push_back(order[length - m]);
+        seeds.push_back(order[length - 1]);
+    }
+
+    TourMetric metric = { n, NULL, cities };
+    int k = min(8, n - 1);
+    int *cand = candidateLists(&metric, k);
+    for (int a = 0; a < n; ++a)
+        for (int i = 0; i < k; ++i)
+            if (cellOf[cand[(size_t)a * k + i]] != cellOf[a])
+            {
+                seeds.push_back(a);
+                break;
+            }
+
+    Result r = improveOrder(&metric, order, cand, k, seeds.data(), (int)seeds.size());
+
+    free(cand);
+    free(order);
+    free(ids);
+    return r;
+}
+
+const int HELD_KARP_MAX = 25;
+const int HELD_KARP_INF = INT_MAX / 2;
+const int HELD_KARP_CHUNK = 2048;
+
+int minPlus(const int *row, const int *col, int m)
+{
+    int best = HELD_KARP_INF;
+    int i = 0;
+#if defined(__AVX512F__)
+    __m512i vmin = _mm512_set1_epi32(HELD_KARP_INF);
+    for (; i + 16 <= m; i += 16)
+        vmin = _mm512_min_epi32(vmin, _mm512_add_epi32(_mm512_loadu_si512(row + i), _mm512_loadu_si512(col + i)));
+    best = _mm512_reduce_min_epi32(vmin);
+#elif defined(__AVX2__)
+    __m256i vmin = _mm256_set1_epi32(HELD_KARP_INF);
+    for (; i + 8 <= m; i += 8)
+        vmin = _mm256_min_epi32(vmin, _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(row + i)), _mm256_loadu_si256((const __m256i *)(col + i))));
+    int values[8];
+    _mm256_storeu_si256((__m256i *)values, vmin);
+    for (int k = 0; k < 8; ++k)
+        best = min(best, values[k]);
+#endif
+    for (; i < m; ++i)
+        best = min(best, row[i] + col[i]);
+    return min(best, HELD_KARP_INF);
+}
+
+unsigned int unrankSubset(long long rank, int k, const long long binom[][HELD_KARP_MAX + 1])
+{
+    unsigned int mask = 0;
+    for (int i = k; i >= 1; --i)
+    {
+        int c = i - 1;
+        while (binom[c + 1][i] <= rank)
+            ++c;
+        mask |= 1u << c;
+        rank -= binom[c][i];
+    }
+    return mask;
+}
+
+void heldKarpLayer(int *dp, const int *columns, int m, int k, const long long binom[][HELD_KARP_MAX + 1], atomic<long long> *next)
+{
+    long long total = binom[m][k];
+    for (long long first = next->fetch_add(HELD_KARP_CHUNK); first < total; first = next->fetch_add(HELD_KARP_CHUNK))
+    {
+        long long last = min(first + HELD_KARP_CHUNK, total);
+        unsigned int s = unrankSubset(first, k, binom);
+        for (long long r = first; r < last; ++r)
+        {
+            int *row = dp + (size_t)s * m;
+            for (int j = 0; j < m; ++j)
+            {
+                if (s >> j & 1)
+                    row[j] = minPlus(dp + (size_t)(s ^ 1u << j) * m, columns + (size_t)j * m, m);
+                else
+                    row[j] = HELD_KARP_INF;
+            }
+            unsigned int low = s & (0u - s);
+            unsigned int ripple = s + low;
+            s = (((ripple ^ s) >> 2) / low) | ripple;
+        }
+    }
+}
+
+Result heldKarp(const int *matrix, int n, int threads = 0)
+{
+    if (threads <= 0)
+        threads = (int)thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    Result r;
+    r.nodes = (ListNode **)calloc(n, sizeof(ListNode *));
+    r.distance = INT_MAX;
+    if (n < 2 || n > HELD_KARP_MAX)
+        return r;
+
+    int m = n - 1;
+    auto weight = [&](int a, int b)
+    {
+        int w = matrix[(size_t)a * n + b];
+        return w == INT_MAX ? HELD_KARP_INF : min(w, HELD_KARP_INF);
+    };
+    int *columns = (int *)malloc((size_t)m * m * sizeof(int));
+    for (int j = 0; j < m; ++j)
+        for (int i = 0; i < m; ++i)
+            columns[(size_t)j * m + i] = weight(i + 1, j + 1);
+
+    int *dp = (int *)malloc(((size_t)1 << m) * m * sizeof(int));
+    if (!dp)
+    {
+        free(columns);
+        return r;
+    }
+
+    long long binom[HELD_KARP_MAX + 1][HELD_KARP_MAX + 1] = {};
+    for (int i = 0; i <= HELD_KARP_MAX; ++i)
+    {
+        binom[i][0] = 1;
+        for (int j = 1; j <= i; ++j)
+            binom[i][j] = binom[i - 1][j - 1] + binom[i - 1][j];
+    }
+
+    for (int j = 0; j < m; ++j)
+    {
+        int *row = dp + ((size_t)1 << j) * m;
+        for (int i = 0; i < m; ++i)
+            row[i] = i == j ? weight(0, j + 1) : HELD_KARP_INF;
+    }
+    for (int k = 2; k <= m; ++k)
+    {
+        atomic<long long> next(0);
+        int used = (int)min<long long>(threads, (binom[m][k] + HELD_KARP_CHUNK - 1) / HELD_KARP_CHUNK);
+        vector<thread> workers;
+        for (int t = 1; t < used; ++t)
+            workers.emplace_back(heldKarpLayer, dp, columns, m, k, binom, &next);
+        heldKarpLayer(dp, columns, m, k, binom, &next);
+        for (auto &w : workers)
+            w.join();
+    }
+
+    unsigned int s = (1u << m) - 1;
+    int last = 0;
+    int best = HELD_KARP_INF;
+    for (int j = 0; j < m; ++j)
+    {
+        int total = min(dp[(size_t)s * m + j] + weight(j + 1, 0), HELD_KARP_INF);
+        if (total < best)
+        {
+            best = total;
+            last = j;
+        }
+    }
+
+    if (best < HELD_KARP_INF)
+    {
+        vector<int> order(n);
+        order[0] = 0;
+        for (int pos = m; pos >= 1; --pos)
+        {
+            order[pos] = last + 1;
+            int value = dp[(size_t)s * m + last];
+            s ^= 1u << last;
+            if (pos == 1)
+                break;
+            const int *row = dp + (size_t)s * m;
+            for (int i = 0; i < m; ++i)
+                if (s >> i & 1 && row[i] + columns[(size_t)last * m + i] == value)
+                {
+                    last = i;
+                    break;
+                }
+        }
+
+        r.distance = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            int a = order[i];
+            int b = order[(i + 1) % n];
+            r.nodes[i] = makeListNode(a, b, matrix[(size_t)a * n + b]);
+            r.distance += matrix[(size_t)a * n + b];
+        }
+    }
+    free(dp);
+    free(columns);
+    return r;
+}
+
+const char EDGE_FREE = 0;
+const char EDGE_INCLUDED = 1;
+const char EDGE_EXCLUDED = 2;
+const double TREE_FORCED = -1e18;
+
+struct BranchNode
+{
+    vector<char> edges;
+    vector<unsigned char> degree;
+    vector<double> pi;
+};
+
+struct OneTree
+{
+    vector<int> parent;
+    vector<int> degree;
+    int first;
+    int second;
+    double bound;
+};
+
+struct WorkDeque
+{
+    mutex lock;
+    deque<BranchNode> nodes;
+};
+
+struct BranchShared
+{
+    const int *matrix;
+    int n;
+    atomic<int> upper;
+    atomic<int> pending;
+    mutex tourLock;
+    int tourCost;
+    vector<int> tour;
+    vector<WorkDeque> deques;
+};
+
+bool excludeEdge(BranchNode &node, int n, int u, int v)
+{
+    if (node.edges[(size_t)u * n + v] == EDGE_INCLUDED)
+        return false;
+    node.edges[(size_t)u * n + v] = node.edges[(size_t)v * n + u] = EDGE_EXCLUDED;
+    for (int w : { u, v })
+    {
+        int available = 0;
+        for (int x = 0; x < n; ++x)
+            if (x != w && node.edges[(size_t)w * n + x] != EDGE_EXCLUDED)
+                ++available;
+        if (available < 2)
+            return false;
+    }
+    return true;
+}
+
+bool includeEdge(BranchNode &node, int n, int u, int v)
+{
+    if (node.edges[(size_t)u * n + v] == EDGE_EXCLUDED)
+        return false;
+    if (node.edges[(size_t)u * n + v] == EDGE_INCLUDED)
+        return true;
+
+    int included = 0;
+    for (int w = 0; w < n; ++w)
+        included += node.degree[w];
+    included /= 2;
+    int prev = v;
+    int end = u;
+    while (node.degree[end] > 0)
+    {
+        int step = -1;
+        for (int x = 0; x < n && step < 0; ++x)
+            if (x != prev && x != end && node.edges[(size_t)end * n + x] == EDGE_INCLUDED)
+                step = x;
+        if (step < 0)
+            break;
+        prev = end;
+        end = step;
+    }
+    if (end == v && included + 1 < n)
+        return false;
+
+    node.edges[(size_t)u * n + v] = node.edges[(size_t)v * n + u] = EDGE_INCLUDED;
+    node.degree[u]++;
+    node.degree[v]++;
+    for (int w : { u, v })
+    {
+        if (node.degree[w] > 2)
+            return false;
+        if (node.degree[w] == 2)
+            for (int x = 0; x < n; ++x)
+                if (x != w && node.edges[(size_t)w * n + x] == EDGE_FREE && !excludeEdge(node, n, w, x))
+                    return false;
+    }
+    return true;
+}
+
+bool buildOneTree(const int *matrix, int n, const BranchNode &node, const double *pi, OneTree &t)
+{
+    auto cost = [&](int a, int b)
+    {
+        char state = node.edges[(size_t)a * n + b];
+        if (state == EDGE_EXCLUDED)
+            return HUGE_VAL;
+        if (state == EDGE_INCLUDED)
+            return TREE_FORCED;
+        return matrix[(size_t)a * n + b] + pi[a] + pi[b];
+    };
+
+    vector<double> key(n, HUGE_VAL);
+    vector<char> inTree(n, 0);
+    t.parent.assign(n, -1);
+    t.degree.assign(n, 0);
+    t.bound = 0;
+    key[1] = 0;
+    for (int i = 1; i < n; ++i)
+    {
+        int u = -1;
+        for (int v = 1; v < n; ++v)
+            if (!inTree[v] && (u < 0 || key[v] < key[u]))
+                u = v;
+        if (key[u] == HUGE_VAL)
+            return false;
+        inTree[u] = 1;
+        if (t.parent[u] >= 0)
+        {
+            t.degree[u]++;
+            t.degree[t.parent[u]]++;
+            t.bound += matrix[(size_t)u * n + t.parent[u]] + pi[u] + pi[t.parent[u]];
+        }
+        for (int v = 1; v < n; ++v)
+        {
+            if (inTree[v])
+                continue;
+            double c = cost(u, v);
+            if (c < key[v])
+            {
+                key[v] = c;
+                t.parent[v] = u;
+            }
+        }
+    }
+
+    t.first = t.second = -1;
+    for (int v = 1; v < n; ++v)
+    {
+        double c = cost(0, v);
+        if (c == HUGE_VAL)
+            continue;
+        if (t.first < 0 || c < cost(0, t.first))
+        {
+            t.second = t.first;
+            t.first = v;
+        }
+        else if (t.second < 0 || c < cost(0, t.second))
+            t.second = v;
+    }
+    if (t.second < 0)
+        return false;
+    for (int v : { t.first, t.second })
+    {
+        t.degree[0]++;
+        t.degree[v]++;
+        t.bound += matrix[v] + pi[0] + pi[v];
+    }
+    for (int v = 0; v < n; ++v)
+        t.bound -= 2 * pi[v];
+    return true;
+}
+
+bool ascend(const int *matrix, int n, const BranchNode &node, vector<double> &pi, int iterations, double lambda, const atomic<int> &upper, OneTree &best)
+{
+    vector<double> current = pi;
+    OneTree t;
+    best.bound = -HUGE_VAL;
+    int stall = 0;
+    for (int it = 0; it < iterations; ++it)
+    {
+        if (!buildOneTree(matrix, n, node, current.data(), t))
+            return false;
+        if (t.bound > best.bound + 1e-9)
+        {
+            best = t;
+            pi = current;
+            stall = 0;
+        }
+        else if (++stall >= 5)
+        {
+            lambda /= 2;
+            stall = 0;
+        }
+
+        int ub = upper.load(memory_order_relaxed);
+        if (ceil(best.bound - 1e-6) >= ub)
+            return true;
+
+        int norm = 0;
+        for (int v = 0; v < n; ++v)
+            norm += (t.degree[v] - 2) * (t.degree[v] - 2);
+        if (norm == 0)
+        {
+            best = t;
+            pi = current;
+            return true;
+        }
+        if (lambda < 1e-4)
+            return true;
+
+        double target = ub == INT_MAX ? t.bound * 1.05 + 1 : ub;
+        double step = lambda * (target - t.bound) / norm;
+        for (int v = 0; v < n; ++v)
+            current[v] += step * (t.degree[v] - 2);
+    }
+    return true;
+}
+
+void recordTour(BranchShared *s, const OneTree &t)
+{
+    int n = s->n;
+    vector<int> next(n, -1), prev(n, -1);
+    auto link = [&](int a, int b)
+    {
+        (next[a] < 0 ? next[a] : prev[a]) = b;
+        (next[b] < 0 ? next[b] : prev[b]) = a;
+    };
+    link(0, t.first);
+    link(0, t.second);
+    for (int v = 1; v < n; ++v)
+        if (t.parent[v] >= 0)
+            link(v, t.parent[v]);
+
+    vector<int> order(n);
+    int cost = 0;
+    for (int i = 0, a = 0, from = -1; i < n; ++i)
+    {
+        order[i] = a;
+        int b = next[a] != from ? next[a] : prev[a];
+        cost += s->matrix[(size_t)a * n + b];
+        from = a;
+        a = b;
+    }
+
+    int ub = s->upper.load();
+    while (cost < ub && !s->upper.compare_exchange_weak(ub, cost))
+        ;
+    lock_guard<mutex> guard(s->tourLock);
+    if (cost < s->tourCost)
+    {
+        s->tourCost = cost;
+        s->tour = order;
+    }
+}
+
+void expandNode(BranchShared *s, BranchNode &node, int self, bool root)
+{
+    int n = s->n;
+    OneTree t;
+    if (!ascend(s->matrix, n, node, node.pi, root ? 50 * n : n, root ? 2.0 : 0.5, s->upper, t))
+        return;
+    if (ceil(t.bound - 1e-6) >= s->upper.load())
+        return;
+
+    int branch = -1;
+    for (int v = 0; v < n; ++v)
+        if (t.degree[v] > 2 && (branch < 0 || t.degree[v] > t.degree[branch]))
+            branch = v;
+    if (branch < 0)
+    {
+        recordTour(s, t);
+        return;
+    }
+
+    int other = -1;
+    double worst = -HUGE_VAL;
+    auto consider = [&](int a, int b)
+    {
+        if ((a == branch || b == branch) && node.edges[(size_t)a * n + b] == EDGE_FREE)
+        {
+            double c = s->matrix[(size_t)a * n + b] + node.pi[a] + node.pi[b];
+            if (c > worst)
+            {
+                worst = c;
+                other = a == branch ? b : a;
+            }
+        }
+    };
+    consider(0, t.first);
+    consider(0, t.second);
+    for (int v = 1; v < n; ++v)
+        if (t.parent[v] >= 0)
+            consider(v, t.parent[v]);
+    if (other < 0)
+        return;
+
+    BranchNode include = node;
+    bool keepInclude = includeEdge(include, n, branch, other);
+    bool keepExclude = excludeEdge(node, n, branch, other);
+
+    WorkDeque &mine = s->deques[self];
+    lock_guard<mutex> guard(mine.lock);
+    if (keepInclude)
+    {
+        s->pending.fetch_add(1);
+        mine.nodes.push_back(move(include));
+    }
+    if (keepExclude)
+    {
+        s->pending.fetch_add(1);
+        mine.nodes.push_back(move(node));
+    }
+}
+
+void branchWorker(BranchShared *s, int self)
+{
+    int threads = (int)s->deques.size();
+    while (s->pending.load() > 0)
+    {
+        BranchNode node;
+        bool found = false;
+        for (int k = 0; k < threads && !found; ++k)
+        {
+            WorkDeque &d = s->deques[(self + k) % threads];
+            lock_guard<mutex> guard(d.lock);
+            if (d.nodes.empty())
+                continue;
+            if (k == 0)
+            {
+                node = move(d.nodes.back());
+                d.nodes.pop_back();
+            }
+            else
+            {
+                node = move(d.nodes.front());
+                d.nodes.pop_front();
+            }
+            found = true;
+        }
+        if (!found)
+        {
+            this_thread::yield();
+            continue;
+        }
+
+        expandNode(s, node, self, false);
+        s->pending.fetch_sub(1);
+    }
+}
+
+Result branchAndBound(const int *matrix, int n, int threads = 0)
+{
+    if (threads <= 0)
+        threads = (int)thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    if (n < 4)
+        return heldKarp(matrix, n, 1);
+
+    BranchNode root;
+    root.edges.assign((size_t)n * n, EDGE_FREE);
+    root.degree.assign(n, 0);
+    root.pi.assign(n, 0);
+    bool complete = true;
+    bool feasible = true;
+    for (int u = 0; u < n && feasible; ++u)
+    {
+        root.edges[(size_t)u * n + u] = EDGE_EXCLUDED;
+        for (int v = u + 1; v < n && feasible; ++v)
+            if (matrix[(size_t)u * n + v] == INT_MAX)
+            {
+                complete = false;
+                feasible = excludeEdge(root, n, u, v);
+            }
+    }
+
+    BranchShared s;
+    s.matrix = matrix;
+    s.n = n;
+    s.tourCost = INT_MAX;
+    Result greedy = nearestNeighborDense(matrix, n, threads);
+    if (greedy.distance != INT_MAX)
+    {
+        Result seed = complete ? improveTour(matrix, n, greedy) : greedy;
+        s.tourCost = seed.distance;
+        s.tour.resize(n);
+        for (int i = 0; i < n; ++i)
+            s.tour[i] = seed.nodes[i]->src;
+        if (complete)
+            freeResult(seed, n);
+    }
+    freeResult(greedy, n);
+    s.upper = s.tourCost;
+    s.deques = vector<WorkDeque>(threads);
+
+    if (feasible)
+    {
+        s.pending = 1;
+        expandNode(&s, root, 0, true);
+        s.pending.fetch_sub(1);
+
+        vector<thread> workers;
+        for (int t = 1; t < threads; ++t)
+            workers.emplace_back(branchWorker, &s, t);
+        branchWorker(&s, 0);
+        for (auto &w : workers)
+            w.join();
+    }
+
+    Result r;
+    r.nodes = (ListNode **)calloc(n, sizeof(ListNode *));
+    r.distance = s.tourCost;
+    if (r.distance != INT_MAX)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            int a = s.tour[i];
+            int b = s.tour[(i + 1) % n];
+            r.nodes[i] = makeListNode(a, b, matrix[(size_t)a * n + b]);
+        }
+    }
+    return r;
+}
+
+void printSolution(int vertices, Result res)
+{
+    for (int i = 0; i < vertices; ++i)
+    {
+        cout << res.nodes[i]->src << " -> " << res.nodes[i]->dest << " : " << res.nodes[i]->weight << endl;
+    }
+    cout << "Distance: " << res.distance << endl;
+}
+
+int main()
+{
+    int V = 7;
+    int directed = false;
+    Graph* graph = makeGraph(V, directed);
+
+    addEdge(graph, 0, 1, 10);
+    addEdge(graph, 0, 3, 4);
+    addEdge(graph, 0, 4, 1);
+    addEdge(graph, 1, 2, 1);
+    addEdge(graph, 1, 4, 3);
+    addEdge(graph, 1, 5, 15);
+    addEdge(graph, 2, 3, 1);
+    addEdge(graph, 2, 4, 2);
+    addEdge(graph, 3, 4, 3);
+    addEdge(graph, 3, 5, 7);
+    addEdge(graph, 3, 6, 5);
+    addEdge(graph, 5, 6, 6);
+
+    // addEdge(graph, 0, 1, 5);
+    // // addEdge(graph, 0, 2, 26);
+    // addEdge(graph, 0, 3, 4);
+    // addEdge(graph, 0, 4, 2);
+    // addEdge(graph, 1, 2, 7);
+    // // addEdge(graph, 1, 3, 21);
+    // addEdge(graph, 1, 4, 3);
+    // addEdge(graph, 2, 3, 6);
+    // addEdge(graph, 2, 4, 2);
+    // addEdge(graph, 3, 4, 1);
+    
+    Result res = nearestNeighbor(graph);
+    
+    printSolution(graph->vertices, res);
+
+    int *matrix = graphToMatrix(graph);
+    Result exact = heldKarp(matrix, V);
+    Result bounded = branchAndBound(matrix, V);
+    if (exact.distance == INT_MAX)
+        cout << endl << "Held-Karp: no tour" << endl;
+    else
+    {
+        cout << endl << "Held-Karp:" << endl;
+        printSolution(V, exact);
+        cout << "Nearest neighbour excess: " << res.distance - exact.distance << endl;
+    }
+    cout << "Branch and bound: " << bounded.distance << (bounded.distance == exact.distance ? " (matches Held-Karp)" : " (differs from Held-Karp)") << endl;
     
+    freeResult(exact, V);
+    freeResult(bounded, V);
+    free(matrix);
     free(graph);
     free(res.nodes);
 }
\ No newline at end of file